@@ -71,16 +71,15 @@
  * Technical Restrictions
  * ======================
  *
- * This header requires rudimentary C++11 support that is provided at least by
- * GNU Compiler Collection starting from GCC 4.8; yet some compiler-related
- * bugs were observed for GCC 4.8:
+ * This header requires C++17 support (`std::string_view` is used by the
+ * document readers). Some compiler-related bugs were observed for older
+ * versions of GCC (4.8) when header was C++11-compatible:
  *  * `auto' return type crashed compiler, see:
  *      https://gcc.gnu.org/bugzilla/show_bug.cgi?id=56014
  *    => resolved by specifying explicit return type for Index::get_entries_for()
  *  * regular expression is not fully supported, regex_compile causes
  *    segmentation fault;
- *    => foreseen different implementation for `is_numeric_literal()', less
- *    efficient
+ *    => `is_numeric_literal()' is implemented without regular expressions
  * */
 
 ///\defgroup compile-definitions Macros steering general features.
@@ -101,15 +100,33 @@
 #include <iomanip>
 #include <cmath>
 #include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <charconv>
 #include <functional>
 #include <sstream>
 #include <vector>
+#include <array>
 #include <limits>
 #include <memory>
 #include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <optional>
+#include <typeinfo>
+#include <new>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <atomic>
 // POSIX-specific
 #include <fts.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 /**\def SDC_NO_IMPLEM
  * \brief Disables inline implementation of SDC routines
@@ -149,6 +166,16 @@
 #       endif
 #   endif
 #   endif
+// compression libraries
+#   ifndef SDC_NO_ZLIB
+#       include <zlib.h>
+#   endif
+#   ifndef SDC_NO_LZMA
+#       include <lzma.h>
+#   endif
+#   ifndef SDC_NO_ZSTD
+#       include <zstd.h>
+#   endif
 #else
 // ROOT (forward definitions)
 #   ifndef NO_ROOT
@@ -196,6 +223,69 @@ class TFormula;  // fwd
 #   endif
 #endif
 
+/**\def SDC_NO_SIMD
+ * \brief Disables vectorized scanning kernels
+ *
+ * When defined to true value, character scanning routines (`aux::simd`)
+ * fall back to scalar implementation. Otherwise, AVX2 or SSE2 version is
+ * chosen depending on target architecture flags (e.g. `-mavx2`).
+ *
+ * \ingroup compile-definitions
+ * */
+#ifndef SDC_NO_SIMD
+#   define SDC_NO_SIMD 0
+#endif
+#if !SDC_NO_SIMD && (defined(__AVX2__) || defined(__SSE2__))
+#   include <immintrin.h>
+#endif
+
+/**\def SDC_NO_ZLIB
+ * \brief Disables support for gzip-compressed documents
+ *
+ * If defined, zlib is not used and gzip-compressed documents can not be
+ * read. Otherwise, application must be linked against zlib (`-lz`).
+ *
+ * \ingroup compile-definitions
+ * */
+
+/**\def SDC_NO_LZMA
+ * \brief Disables support for xz-compressed documents
+ *
+ * If defined, liblzma is not used and xz-compressed documents can not be
+ * read. Otherwise, application must be linked against liblzma (`-llzma`).
+ *
+ * \ingroup compile-definitions
+ * */
+
+/**\def SDC_NO_ZSTD
+ * \brief Disables support for zstd-compressed documents
+ *
+ * If defined, libzstd is not used and zstd-compressed documents can not be
+ * read. Otherwise, application must be linked against libzstd (`-lzstd`).
+ *
+ * \ingroup compile-definitions
+ * */
+
+/**\def SDC_NO_INOTIFY
+ * \brief Disables use of inotify by `DocumentsWatcher`
+ *
+ * When defined to true value, `DocumentsWatcher` always walks the watched
+ * subtree to find out changes. Defaults to true on platforms other than
+ * Linux.
+ *
+ * \ingroup compile-definitions
+ * */
+#ifndef SDC_NO_INOTIFY
+#   ifdef __linux__
+#       define SDC_NO_INOTIFY 0
+#   else
+#       define SDC_NO_INOTIFY 1
+#   endif
+#endif
+#if !SDC_NO_INOTIFY
+#   include <sys/inotify.h>
+#endif
+
 // Compiler version macros to switch between implementations of some routines
 #ifdef __GNUC__
 /**\def GNU_C_COMPILER_VERSION
@@ -206,13 +296,36 @@ class TFormula;  // fwd
 #   define GNU_C_COMPILER_VERSION (__GNUC__ * 10000 + __GNUC_MINOR__ * 100 + __GNUC_PATCHLEVEL__)
 #endif
 
-#if GNU_C_COMPILER_VERSION >= 40900
-    // GCC < 4.9 has broken support for C++11 regular expressions
-    #include <regex>
+/**\def SDC_FLOAT_FROM_CHARS
+ * \brief Enables `std::from_chars()` for floating point numbers
+ *
+ * Floating point overloads of `std::from_chars()` are not provided by older
+ * standard libraries (e.g. libstdc++ <11). When this macro is false,
+ * `aux::parse_numeric()` converts floating point literals with `strtod()`
+ * and friends instead. By default is set depending on `__cpp_lib_to_chars`.
+ *
+ * \ingroup compile-definitions
+ * */
+#ifndef SDC_FLOAT_FROM_CHARS
+#   if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#       define SDC_FLOAT_FROM_CHARS 1
+#   else
+#       define SDC_FLOAT_FROM_CHARS 0
+#   endif
+#endif
 
-    #ifndef SDC_NUMERIC_REGEX
-    #   define SDC_NUMERIC_REGEX "^[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?$"
-    #endif
+/**\def SDC_TFORMULA_FALLBACK
+ * \brief Enables ROOT's `TFormula` for expressions not handled natively
+ *
+ * Arithmetic expressions in numeric values are evaluated by
+ * `aux::evaluate_arithmetic()`. If this macro is set to true value (and ROOT
+ * is enabled), expressions rejected by the built-in evaluator are forwarded
+ * to `TFormula`. Disabled by default.
+ *
+ * \ingroup compile-definitions
+ * */
+#ifndef SDC_TFORMULA_FALLBACK
+#   define SDC_TFORMULA_FALLBACK 0
 #endif
 
 //
@@ -795,6 +908,145 @@ trim(const std::string & strexpr ) SDC_ENDDECL
 }
 #endif
 
+///\brief Trims spaces from left and right of the string view (no copy)
+///
+///\ingroup utils
+inline std::string_view
+trim_view(std::string_view strexpr) {
+    size_t b = 0, e = strexpr.size();
+    while( b < e && std::isspace(static_cast<unsigned char>(strexpr[b])) ) ++b;
+    while( e > b && std::isspace(static_cast<unsigned char>(strexpr[e-1])) ) --e;
+    return strexpr.substr(b, e - b);
+}
+
+/**\brief Vectorized character scanning kernels
+ *
+ * Used by the line reader, ExtCSV grammar handlers and tokenizers to find
+ * newlines, comment and metadata marker characters and whitespace token
+ * boundaries in bulk. Implementation is chosen at compile time: AVX2 (32
+ * bytes per step), SSE2 (16 bytes per step) or scalar fallback (see
+ * `SDC_NO_SIMD`). Whitespace is considered as in C locale's `isspace()`.
+ *
+ * Each kernel returns pointer to the first matching character within
+ * `[b, e)` range, or `e` if none found.
+ *
+ * \ingroup utils
+ * */
+namespace simd {
+
+/// Scalar predicate for whitespace characters (C locale)
+inline bool is_space(char c) {
+    return c == ' ' || (static_cast<unsigned char>(c) - 0x9u) < 5u;
+}
+
+#if !SDC_NO_SIMD && defined(__AVX2__)
+/// Width of vector register used, bytes
+constexpr size_t width = 32;
+typedef __m256i Vec;
+inline Vec load(const char * p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+inline Vec splat(char c) { return _mm256_set1_epi8(c); }
+inline Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vec or_(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm256_sub_epi8(a, b); }
+inline Vec min_u8(Vec a, Vec b) { return _mm256_min_epu8(a, b); }
+inline uint32_t mask(Vec v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+#   define SDC_SIMD_ENABLED 1
+#elif !SDC_NO_SIMD && defined(__SSE2__)
+/// Width of vector register used, bytes
+constexpr size_t width = 16;
+typedef __m128i Vec;
+inline Vec load(const char * p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline Vec splat(char c) { return _mm_set1_epi8(c); }
+inline Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+inline Vec or_(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm_sub_epi8(a, b); }
+inline Vec min_u8(Vec a, Vec b) { return _mm_min_epu8(a, b); }
+inline uint32_t mask(Vec v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+#   define SDC_SIMD_ENABLED 1
+#else
+/// Width of vector register used, bytes (no vectorization)
+constexpr size_t width = 1;
+#   define SDC_SIMD_ENABLED 0
+#endif
+
+/// Generic scanning loop; `MatchT` shall provide scalar `match(char)` and
+/// (if vectorization enabled) vectorized `match(Vec)` returning bitmask
+template<typename MatchT> const char *
+scan(const char * b, const char * e, const MatchT & m) {
+    #if SDC_SIMD_ENABLED
+    for( ; b + width <= e; b += width ) {
+        uint32_t msk = m.match(load(b));
+        if( msk ) return b + __builtin_ctz(msk);
+    }
+    #endif
+    for( ; b != e; ++b ) if( m.match(*b) ) return b;
+    return e;
+}
+
+/// Matches single character
+struct CharMatch {
+    char c;
+    #if SDC_SIMD_ENABLED
+    Vec vc;
+    CharMatch(char c_) : c(c_), vc(splat(c_)) {}
+    uint32_t match(Vec v) const { return mask(eq(v, vc)); }
+    #else
+    CharMatch(char c_) : c(c_) {}
+    #endif
+    bool match(char x) const { return x == c; }
+};
+
+/// Matches any of two characters
+struct AnyOf2Match {
+    char c1, c2;
+    #if SDC_SIMD_ENABLED
+    Vec vc1, vc2;
+    AnyOf2Match(char c1_, char c2_) : c1(c1_), c2(c2_), vc1(splat(c1_)), vc2(splat(c2_)) {}
+    uint32_t match(Vec v) const { return mask(or_(eq(v, vc1), eq(v, vc2))); }
+    #else
+    AnyOf2Match(char c1_, char c2_) : c1(c1_), c2(c2_) {}
+    #endif
+    bool match(char x) const { return x == c1 || x == c2; }
+};
+
+/// Matches whitespace (or non-whitespace if `Negate` is set)
+template<bool Negate>
+struct SpaceMatch {
+    #if SDC_SIMD_ENABLED
+    Vec vSpace, vTab, vFour;
+    SpaceMatch() : vSpace(splat(' ')), vTab(splat('\t')), vFour(splat(4)) {}
+    uint32_t match(Vec v) const {
+        // `\t', `\n', `\v', `\f', `\r' are 0x9-0xd
+        Vec d = sub(v, vTab);
+        uint32_t msk = mask(or_(eq(v, vSpace), eq(min_u8(d, vFour), d)));
+        if( Negate ) msk = ~msk & static_cast<uint32_t>((uint64_t(1) << width) - 1);
+        return msk;
+    }
+    #endif
+    bool match(char x) const { return Negate != is_space(x); }
+};
+
+/// Finds first occurence of the character
+inline const char * find_char(const char * b, const char * e, char c)
+    { return scan(b, e, CharMatch(c)); }
+/// Finds first occurence of any of two characters
+inline const char * find_any_of(const char * b, const char * e, char c1, char c2)
+    { return scan(b, e, AnyOf2Match(c1, c2)); }
+/// Finds first whitespace character
+inline const char * find_space(const char * b, const char * e)
+    { return scan(b, e, SpaceMatch<false>()); }
+/// Finds first non-whitespace character
+inline const char * find_non_space(const char * b, const char * e)
+    { return scan(b, e, SpaceMatch<true>()); }
+
+/// Returns position of the character in the string view or `npos`
+inline size_t find(std::string_view s, char c) {
+    const char * p = find_char(s.data(), s.data() + s.size(), c);
+    return p == s.data() + s.size() ? std::string_view::npos : p - s.data();
+}
+
+}  // namespace ::sdc::aux::simd
+
 ///\brief Helper function for tokenization
 ///
 ///\ingroup utils
@@ -803,15 +1055,15 @@ tokenize(const std::string & expr, char delim) SDC_ENDDECL
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
 {
     std::list<std::string> r;
+    const std::string_view exprView(expr);
     size_t b = 0, e;
     do {
-        e = expr.find(delim, b);
-        std::string tok = expr.substr( b, e == std::string::npos
-                                          ? std::string::npos
-                                          : e - b
-                                     );
-        tok = ::sdc::aux::trim(tok);
-        r.push_back(tok);
+        e = simd::find(exprView.substr(b), delim);
+        if( e != std::string::npos ) e += b;
+        // token is trimmed before copying, so no intermediate strings
+        r.emplace_back(trim_view(exprView.substr( b, e == std::string::npos
+                                                     ? std::string::npos
+                                                     : e - b )));
         b = e+1;
     } while( e != std::string::npos );
     return r;
@@ -825,13 +1077,133 @@ SDC_INLINE std::list<std::string>
 tokenize(const std::string & expr) SDC_ENDDECL
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
 {
-    std::istringstream iss(expr);
-    return { std::istream_iterator<std::string>{iss}
-           , std::istream_iterator<std::string>{}
-           };
+    std::list<std::string> r;
+    const char * b = expr.data()
+             , * e = expr.data() + expr.size();
+    while( (b = simd::find_non_space(b, e)) != e ) {
+        const char * tokEnd = simd::find_space(b, e);
+        r.emplace_back(b, tokEnd);
+        b = tokEnd;
+    }
+    return r;
+}
+#endif
+
+/**\brief Vector keeping first `N` elements in place
+ *
+ * Switches to heap storage only when grows beyond `N` elements. Restricted to
+ * trivially copyable types (e.g. `std::string_view`) for simplicity.
+ *
+ * \ingroup utils
+ * */
+template<typename T, size_t N>
+class SmallVector {
+    static_assert( std::is_trivially_copyable<T>::value
+                 , "SmallVector is for trivially copyable types only" );
+private:
+    T _inplace[N];
+    std::vector<T> _heap;
+    size_t _size;
+public:
+    typedef T value_type;
+    typedef const T * const_iterator;
+
+    SmallVector() : _size(0) {}
+
+    const T * data() const { return _size > N ? _heap.data() : _inplace; }
+    size_t size() const { return _size; }
+    bool empty() const { return !_size; }
+    const T & operator[](size_t n) const { return data()[n]; }
+    const T & back() const { return data()[_size - 1]; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + _size; }
+
+    void push_back(const T & v) {
+        if( _size < N ) {
+            _inplace[_size++] = v;
+            return;
+        }
+        if( _size == N ) _heap.assign(_inplace, _inplace + N);
+        _heap.push_back(v);
+        ++_size;
+    }
+    void clear() { _size = 0; }
+};
+
+/// Tokens of the line, referring to the line's content
+///
+///\ingroup utils
+typedef SmallVector<std::string_view, 32> Tokens;
+
+///\brief Tokenizes expression by spaces, without copying the tokens
+///
+/// Same as `tokenize(expr)`, but tokens refer to the `expr` content, so
+/// for typical lines no heap allocation happens at all.
+///
+///\ingroup utils
+SDC_INLINE Tokens
+tokenize_view(std::string_view expr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    Tokens r;
+    const char * b = expr.data()
+             , * e = expr.data() + expr.size();
+    while( (b = simd::find_non_space(b, e)) != e ) {
+        const char * tokEnd = simd::find_space(b, e);
+        r.push_back(std::string_view(b, tokEnd - b));
+        b = tokEnd;
+    }
+    return r;
+}
+#endif
+
+///\brief Tokenizes expression by delimiter, without copying the tokens
+///
+/// Same as `tokenize(expr, delim)` (tokens are trimmed), but tokens refer to
+/// the `expr` content.
+///
+///\ingroup utils
+SDC_INLINE Tokens
+tokenize_view(std::string_view expr, char delim) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    Tokens r;
+    size_t b = 0, e;
+    do {
+        e = simd::find(expr.substr(b), delim);
+        if( e != std::string_view::npos ) e += b;
+        r.push_back(trim_view(expr.substr( b, e == std::string_view::npos
+                                              ? std::string_view::npos
+                                              : e - b )));
+        b = e+1;
+    } while( e != std::string_view::npos );
+    return r;
 }
 #endif
 
+///\brief Strips comments and surrounding spaces from the line read
+///
+/// Used by `getline()` and by the loaders that read lines on their own (e.g.
+/// to keep track on the byte offsets within a document). See `getline()` for
+/// `CommentCallableT` requirements.
+///
+///\ingroup utils
+template<typename CommentCallableT>
+void strip_line( std::string & buf, CommentCallableT comment_f ) {
+    {  // strip comments
+        std::pair<size_t, size_t> commentBounds;
+        while( (commentBounds = comment_f(buf)).first != std::string::npos ) {
+            buf = buf.replace(commentBounds.first, commentBounds.second, "");
+            assert( commentBounds.second != 0 ); // TODO: to support
+            // multiline comments we shall check second element of
+            // returned pair, and if it is 0, iterate with STL's getline()
+            // until comment_f() will return non-npos. This feature is to
+            // be implemented at some point...
+        }
+    }
+    buf = sdc::aux::trim(buf);
+}
+
 ///\brief Reads next meaningful line from stream. Returns `false' on EOF
 ///
 /// Used to obtain line from ASCII documents in line-based formats
@@ -865,181 +1237,615 @@ bool getline( std::istream & ifs
         }
         std::getline( ifs, buf );
         ++lineNo;
-        {  // strip comments
-            std::pair<size_t, size_t> commentBounds;
-            while( (commentBounds = comment_f(buf)).first != std::string::npos ) {
-                buf = buf.replace(commentBounds.first, commentBounds.second, "");
-                assert( commentBounds.second != 0 ); // TODO: to support
-                // multiline comments we shall check second element of
-                // returned pair, and if it is 0, iterate with STL's getline()
-                // until comment_f() will return non-npos. This feature is to
-                // be implemented at some point...
-            }
-        }
-        buf = sdc::aux::trim(buf);
+        strip_line(buf, comment_f);
     } while(buf.empty());
-    buf = sdc::aux::trim(buf);
     return true;
 }
 
-//                                                      _______________________
-// ___________________________________________________/ Lexical Cast Utilities
+//                                                             ________________
+// __________________________________________________________/ Arena Allocator
 
-///\brief Returns `true` if given string expression looks like a numeric literal
-///
-///\ingroup utils
-inline bool
-is_numeric_literal( const std::string & s ) {
-    if( 'n' == tolower(s[0]) && 'a' == tolower(s[1]) && 'n' == tolower(s[2])
-    && s.size() == 3 ) {
-        return true;
-    }  // inf?
-    #if GNU_C_COMPILER_VERSION >= 40900
-    static const std::regex rx(SDC_NUMERIC_REGEX);
-    return std::regex_match(s, rx);
-    #else
-    // GCC 4.8 has malfunctioning support for regular expressons
-    std::size_t pos;
-    try {
-        std::stold(s, &pos);
-    } catch(std::invalid_argument&) {
-        return false;
-    } catch(std::out_of_range&) {
-        return false;
+/**\brief Bump allocator for short-lived parsing temporaries
+ *
+ * Hands out memory from a list of chunks by advancing a pointer; individual
+ * deallocations are no-ops and all the memory is released at once by
+ * `reset()`. Chunks are retained for re-use, so once warmed up, the arena
+ * does not hit heap allocator at all.
+ *
+ * Loading routines of `Documents` open an `ArenaScope` for the operation;
+ * the arena is then available to parsers via `RowContext::arena` (or
+ * `Arena::current()`) and released when the loading operation ends. Library
+ * itself puts there only temporaries that can not escape the call (e.g.
+ * tokens index of `ColumnsOrder::interpret()`). Objects with non-trivial
+ * destructors are not destroyed -- use arena only for temporaries (e.g. with
+ * `ArenaAllocator`), never for parsed items.
+ *
+ * \ingroup utils
+ * */
+class Arena {
+public:
+    /// Default size of the chunk, bytes
+    static constexpr size_t defaultChunkSize = 64*1024;
+    /// Capacity kept by `reset()` by default, bytes
+    static constexpr size_t defaultRetainBytes = 16*1024*1024;
+private:
+    /// Allocated chunks (pointer and size)
+    std::vector< std::pair<std::unique_ptr<char[]>, size_t> > _chunks;
+    /// Current chunk number
+    size_t _nChunk;
+    /// Bytes used in current chunk
+    size_t _used;
+    /// Size of newly allocated chunks
+    const size_t _chunkSize;
+    /// Bytes handed out since last reset
+    size_t _nBytes;
+
+    /// Switches to next chunk having enough space, allocates it if need
+    void * _allocate_slow(size_t n, size_t align);
+    /// Pointer to arena of the active scope
+    static Arena *& _current_ptr();
+public:
+    explicit Arena(size_t chunkSize=defaultChunkSize)
+        : _nChunk(0), _used(0), _chunkSize(chunkSize), _nBytes(0) {}
+    Arena(const Arena &) = delete;
+    Arena & operator=(const Arena &) = delete;
+
+    /// Returns memory block of given size and (power of two) alignment
+    void * allocate(size_t n, size_t align=alignof(std::max_align_t)) {
+        if( _nChunk < _chunks.size() ) {
+            const uintptr_t base = reinterpret_cast<uintptr_t>(_chunks[_nChunk].first.get());
+            const size_t offset = ((base + _used + align - 1) & ~uintptr_t(align - 1)) - base;
+            if( offset + n <= _chunks[_nChunk].second ) {
+                _used = offset + n;
+                _nBytes += n;
+                return _chunks[_nChunk].first.get() + offset;
+            }
+        }
+        return _allocate_slow(n, align);
     }
-    return pos == s.size();
-    #endif
-}
 
-///\brief Lexical cast traits; define to-/from- string conversions for various types
-///
-///\ingroup utils
-template<typename T, class=void> struct LexicalTraits;
+    /// Copies string into the arena
+    std::string_view copy(std::string_view s) {
+        char * dest = static_cast<char *>(allocate(s.size(), 1));
+        memcpy(dest, s.data(), s.size());
+        return std::string_view(dest, s.size());
+    }
 
-///\brief SDC's function for lexical cast. Meant to be used with specializations
-///
-///\ingroup utils
-template<typename T> T lexical_cast(const std::string & s);
+    /// Constructs object of trivially-destructible type in the arena
+    template<typename T, typename ... ArgsT> T *
+    make(ArgsT && ... args) {
+        static_assert( std::is_trivially_destructible<T>::value
+                     , "arena never calls destructors" );
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<ArgsT>(args)...);
+    }
 
-///\brief Specialization for STL string (trivial)
-///
-///\ingroup utils
-template<> SDC_INLINE std::string
-lexical_cast<std::string>(const std::string & s) SDC_ENDDECL
-#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
-{
-    return s;
-}
-#endif
+    /// Releases all the allocated memory at once
+    ///
+    /// Chunks are kept for re-use, up to given total capacity.
+    void reset(size_t retainBytes=defaultRetainBytes);
+
+    /// Bytes handed out since last reset
+    size_t n_bytes() const { return _nBytes; }
+    /// Total size of allocated chunks, bytes
+    size_t capacity() const {
+        size_t c = 0;
+        for( const auto & chunk : _chunks ) c += chunk.second;
+        return c;
+    }
+
+    /// Returns arena of the innermost active `ArenaScope` of the current
+    /// thread, or null if there is none
+    static Arena * current() { return _current_ptr(); }
+
+    friend class ArenaScope;
+};
 
-///\brief Specialization for boolean value
-///
-///\ingroup utils
-template<> SDC_INLINE bool
-lexical_cast<bool>(const std::string & strexpr) SDC_ENDDECL
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
-{
-    static const std::set<std::string> trueLiterals
-        = { "True", "true", "TRUE", "yes", "1" },
-        falseLiterals = { "False", "false", "FALSE", "no", "0" };
+SDC_INLINE void *
+Arena::_allocate_slow(size_t n, size_t align) {
+    // look for retained chunk of sufficient size
+    for( ++_nChunk; _nChunk < _chunks.size(); ++_nChunk ) {
+        if( n + align <= _chunks[_nChunk].second ) break;
+    }
+    if( _nChunk >= _chunks.size() ) {
+        const size_t size = std::max(_chunkSize, n + align);
+        _chunks.emplace_back(std::unique_ptr<char[]>(new char[size]), size);
+        _nChunk = _chunks.size() - 1;
+    }
+    _used = 0;
+    return allocate(n, align);
+}
 
-    auto it = trueLiterals.find(strexpr);
-    if( it != trueLiterals.end() ) return true;
-    it = falseLiterals.find(strexpr);
-    if( it != falseLiterals.end() ) return false;
+SDC_INLINE void
+Arena::reset(size_t retainBytes) {
+    size_t c = 0, nKeep = 0;
+    while( nKeep < _chunks.size() && c + _chunks[nKeep].second <= retainBytes ) {
+        c += _chunks[nKeep++].second;
+    }
+    _chunks.resize(nKeep);
+    _nChunk = 0;
+    _used = 0;
+    _nBytes = 0;
+}
 
-    throw errors::ParserError( "expression does not look like boolean literal"
-            , strexpr );
+SDC_INLINE Arena *&
+Arena::_current_ptr() {
+    static thread_local Arena * ptr = nullptr;
+    return ptr;
 }
 #endif
 
-///\brief Specialization for standard signed integer
-///
-///\ingroup utils
-template<> SDC_INLINE int
-lexical_cast<int>(const std::string & strexpr) SDC_ENDDECL
+/**\brief Makes (per-thread) arena available for the scope
+ *
+ * Outermost scope of the thread activates the thread's arena and resets it
+ * on exit. Nested scopes do nothing, so memory allocated within the
+ * outermost scope remains valid until it ends.
+ *
+ * \ingroup utils
+ * */
+class ArenaScope {
+private:
+    Arena * _arena;
+public:
+    ArenaScope();
+    ~ArenaScope();
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope & operator=(const ArenaScope &) = delete;
+};
+
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
-{
-    try {
-        return std::stoi(strexpr);
-    } catch( const std::invalid_argument & ) {
-        throw errors::ParserError( "stoi(): no conversion can be performed"
-                                 , strexpr );
-    } catch( const std::out_of_range & ) {
-        throw errors::ParserError( "stoi(): out of range", strexpr);
-    }
+SDC_INLINE
+ArenaScope::ArenaScope() : _arena(nullptr) {
+    if( Arena::_current_ptr() ) return;  // nested scope
+    static thread_local Arena arena;
+    _arena = Arena::_current_ptr() = &arena;
+}
+
+SDC_INLINE
+ArenaScope::~ArenaScope() {
+    if( !_arena ) return;
+    Arena::_current_ptr() = nullptr;
+    _arena->reset();
 }
 #endif
 
-///\brief Specialization for long unsigned integer
+/**\brief STL-compatible allocator using `Arena`
+ *
+ * Allocator with null arena falls back to the heap, so containers can be used
+ * the same way whether arena is available or not.
+ *
+ * \ingroup utils
+ * */
+template<typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    Arena * arena;
+
+    ArenaAllocator(Arena * arena_=Arena::current()) noexcept : arena(arena_) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> & o) noexcept : arena(o.arena) {}
+
+    T * allocate(size_t n) {
+        if( !arena ) return static_cast<T *>(::operator new(n*sizeof(T)));
+        return static_cast<T *>(arena->allocate(n*sizeof(T), alignof(T)));
+    }
+    void deallocate(T * p, size_t) noexcept {
+        if( !arena ) ::operator delete(p);
+    }
+
+    template<typename U> bool operator==(const ArenaAllocator<U> & o) const
+        { return arena == o.arena; }
+    template<typename U> bool operator!=(const ArenaAllocator<U> & o) const
+        { return arena != o.arena; }
+};
+
+/// Vector allocated in arena (or heap, if there is no arena)
 ///
 ///\ingroup utils
-template<> SDC_INLINE unsigned long
-lexical_cast<unsigned long>(const std::string & strexpr) SDC_ENDDECL
-#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
-{
-    try {
-        return std::stoul(strexpr);
-    } catch( const std::invalid_argument & ) {
-        throw errors::ParserError( "stoul(): no conversion can be performed"
-                                 , strexpr );
-    } catch( const std::out_of_range & ) {
-        throw errors::ParserError( "stoul(): out of range", strexpr);
-    }
-}
-#endif
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+/// String allocated in arena (or heap, if there is no arena)
+///
+///\ingroup utils
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
 
-///\brief Specialization for long unsigned integer
+//                                                      _______________________
+// ___________________________________________________/ Lexical Cast Utilities
+
+///\brief Returns `true` if given string expression looks like a numeric literal
+///
+/// Matches optionally signed decimal number with optional fraction and
+/// exponent (e.g. `42`, `-.033e-64`, `+1.5E3`) or `nan` literal. Does not
+/// perform the conversion -- see `parse_numeric()`.
 ///
 ///\ingroup utils
-template<> SDC_INLINE long int
-lexical_cast<long int>(const std::string & strexpr) SDC_ENDDECL
-#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
-{
-    try {
-        return std::stol(strexpr);
-    } catch( const std::invalid_argument & ) {
-        throw errors::ParserError( "stol(): no conversion can be performed"
-                                 , strexpr );
-    } catch( const std::out_of_range & ) {
-        throw errors::ParserError( "stol(): out of range", strexpr);
+inline bool
+is_numeric_literal( std::string_view s ) {
+    if( 3 == s.size() && 'n' == tolower(s[0]) && 'a' == tolower(s[1])
+     && 'n' == tolower(s[2]) ) {
+        return true;
+    }  // inf?
+    std::string_view::const_iterator it = s.begin();
+    auto skip_digits = [&]() {
+            const std::string_view::const_iterator b = it;
+            while( it != s.end() && '0' <= *it && *it <= '9' ) ++it;
+            return it != b;
+        };
+    if( it != s.end() && ('-' == *it || '+' == *it) ) ++it;
+    bool hasMantissa = skip_digits();
+    if( it != s.end() && '.' == *it ) {
+        ++it;
+        hasMantissa = skip_digits();  // digits after point are mandatory
     }
+    if( !hasMantissa ) return false;
+    if( it != s.end() && ('e' == *it || 'E' == *it) ) {
+        ++it;
+        if( it != s.end() && ('-' == *it || '+' == *it) ) ++it;
+        if( !skip_digits() ) return false;
+    }
+    return it == s.end();
 }
-#endif
 
-///\brief Specialization for single-precision floating point number (supports
-///       arithmetics)
+/**\brief Converts numeric literal to arithmetic type without exceptions
+ *
+ * Validates and converts given string in a single pass with
+ * `std::from_chars()` (or with `strto*()` family for floating point types if
+ * `SDC_FLOAT_FROM_CHARS` is false). Entire string must be consumed; single
+ * leading `+` is permitted, surrounding whitespaces are not. Floating point
+ * types additionally accept `nan`, `inf` and `infinity`.
+ *
+ * \returns `std::errc()` on success, `std::errc::invalid_argument` if string
+ *      is not a numeric literal and `std::errc::result_out_of_range` if value
+ *      does not fit the type. Destination is not modified on failure.
+ *
+ * \ingroup utils
+ * */
+template<typename T> std::errc
+parse_numeric( std::string_view s, T & dest ) {
+    static_assert( std::is_arithmetic<T>::value && !std::is_same<T, bool>::value
+                 , "parse_numeric() is defined only for arithmetic types" );
+    const char * b = s.data()
+             , * e = s.data() + s.size()
+             ;
+    if( b != e && '+' == *b ) {
+        ++b;
+        if( b != e && '-' == *b ) return std::errc::invalid_argument;
+    }
+    if( b == e ) return std::errc::invalid_argument;
+    #if SDC_FLOAT_FROM_CHARS
+    const std::from_chars_result r = std::from_chars(b, e, dest);
+    if( std::errc() != r.ec ) return r.ec;
+    return r.ptr == e ? std::errc() : std::errc::invalid_argument;
+    #else
+    if constexpr (std::is_integral<T>::value) {
+        const std::from_chars_result r = std::from_chars(b, e, dest);
+        if( std::errc() != r.ec ) return r.ec;
+        return r.ptr == e ? std::errc() : std::errc::invalid_argument;
+    } else {
+        // strto*() require null-terminated string; use stack buffer for
+        // typical literals
+        char shortBuf[64];
+        std::string longBuf;
+        const size_t n = e - b;
+        const char * cs = shortBuf;
+        if( n < sizeof(shortBuf) ) {
+            memcpy(shortBuf, b, n);
+            shortBuf[n] = '\0';
+        } else {
+            longBuf.assign(b, n);
+            cs = longBuf.c_str();
+        }
+        if( isspace((unsigned char) *cs) ) return std::errc::invalid_argument;
+        char * end = nullptr;
+        errno = 0;
+        T v;
+        if constexpr (std::is_same<T, float>::value) v = strtof(cs, &end);
+        else if constexpr (std::is_same<T, double>::value) v = strtod(cs, &end);
+        else v = strtold(cs, &end);
+        if( end != cs + n ) return std::errc::invalid_argument;
+        if( ERANGE == errno ) return std::errc::result_out_of_range;
+        dest = v;
+        return std::errc();
+    }
+    #endif
+}
+
+/**\brief Evaluates constant arithmetic expression
+ *
+ * Built-in recursive descent evaluator for the arithmetic subset typically
+ * met in calibration data: binary `+ - * /`, power (`^` or `**`, right
+ * associative), unary signs, parentheses, numeric literals, constants `pi`
+ * and `e`, functions of one argument `sqrt`, `exp`, `log`, `log10`, `abs`,
+ * `sin`, `cos`, `tan` and `pow(x, y)`. Since expression contains no
+ * variables, it is folded to a single value while being parsed.
+ *
+ * \throws `errors::ParserError` if expression is malformed
+ *
+ * \ingroup utils
+ * */
+SDC_INLINE double
+evaluate_arithmetic(std::string_view strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    struct Parser {
+        std::string_view s;
+        size_t pos;
+
+        [[noreturn]] void fail(const char * reason) const {
+            char errBuf[128];
+            snprintf(errBuf, sizeof(errBuf), "%s at position %zu", reason, pos);
+            throw errors::ParserError(errBuf, std::string(s));
+        }
+        // skips whitespaces and returns current char (0 at the end)
+        char peek() {
+            while( pos < s.size() && isspace((unsigned char) s[pos]) ) ++pos;
+            return pos < s.size() ? s[pos] : '\0';
+        }
+        bool is_digit(size_t i) const {
+            return i < s.size() && '0' <= s[i] && s[i] <= '9';
+        }
+        double number() {
+            const size_t b = pos;
+            while( is_digit(pos) ) ++pos;
+            if( pos < s.size() && '.' == s[pos] ) {
+                ++pos;
+                while( is_digit(pos) ) ++pos;
+            }
+            if( pos < s.size() && ('e' == s[pos] || 'E' == s[pos]) ) {
+                size_t e = pos + 1;
+                if( e < s.size() && ('-' == s[e] || '+' == s[e]) ) ++e;
+                if( is_digit(e) ) {
+                    pos = e;
+                    while( is_digit(pos) ) ++pos;
+                }
+            }
+            double v;
+            if( std::errc() != parse_numeric(s.substr(b, pos - b), v) ) {
+                pos = b;
+                fail("bad numeric literal");
+            }
+            return v;
+        }
+        double primary() {
+            const char c = peek();
+            if( '(' == c ) {
+                ++pos;
+                const double v = expr();
+                if( ')' != peek() ) fail("expected closing parenthesis");
+                ++pos;
+                return v;
+            }
+            if( ('0' <= c && c <= '9') || '.' == c ) return number();
+            if( !(isalpha((unsigned char) c) || '_' == c) ) {
+                fail(c ? "unexpected character" : "unexpected end of expression");
+            }
+            const size_t b = pos;
+            while( pos < s.size()
+                && (isalnum((unsigned char) s[pos]) || '_' == s[pos]) ) ++pos;
+            const std::string_view id = s.substr(b, pos - b);
+            if( '(' != peek() ) {
+                if( "pi" == id ) return 3.14159265358979323846;
+                if( "e" == id ) return 2.71828182845904523536;
+                pos = b;
+                fail("unknown constant");
+            }
+            ++pos;
+            const double x = expr();
+            if( "pow" == id ) {
+                if( ',' != peek() ) fail("expected second argument");
+                ++pos;
+                const double y = expr();
+                if( ')' != peek() ) fail("expected closing parenthesis");
+                ++pos;
+                return std::pow(x, y);
+            }
+            if( ')' != peek() ) fail("expected closing parenthesis");
+            ++pos;
+            if( "sqrt"  == id ) return std::sqrt(x);
+            if( "exp"   == id ) return std::exp(x);
+            if( "log"   == id ) return std::log(x);
+            if( "log10" == id ) return std::log10(x);
+            if( "abs"   == id ) return std::fabs(x);
+            if( "sin"   == id ) return std::sin(x);
+            if( "cos"   == id ) return std::cos(x);
+            if( "tan"   == id ) return std::tan(x);
+            pos = b;
+            fail("unknown function");
+        }
+        double power() {
+            const double base = primary();
+            const char c = peek();
+            if( '^' == c ) {
+                ++pos;
+                return std::pow(base, unary());
+            }
+            if( '*' == c && pos + 1 < s.size() && '*' == s[pos+1] ) {
+                pos += 2;
+                return std::pow(base, unary());
+            }
+            return base;
+        }
+        double unary() {
+            const char c = peek();
+            if( '-' == c ) { ++pos; return -unary(); }
+            if( '+' == c ) { ++pos; return  unary(); }
+            return power();
+        }
+        double term() {
+            double v = unary();
+            for(;;) {
+                const char c = peek();
+                if( '*' == c ) { ++pos; v *= unary(); }
+                else if( '/' == c ) { ++pos; v /= unary(); }
+                else return v;
+            }
+        }
+        double expr() {
+            double v = term();
+            for(;;) {
+                const char c = peek();
+                if( '+' == c ) { ++pos; v += term(); }
+                else if( '-' == c ) { ++pos; v -= term(); }
+                else return v;
+            }
+        }
+    } p{strexpr, 0};
+    const double v = p.expr();
+    if( p.peek() ) p.fail("unexpected character");
+    return v;
+}
+#endif
+
+///\brief Evaluates arithmetic expression with memoization
+///
+/// Results are cached per thread by expression string, so repeating formulae
+/// cost one hash look-up. Expressions not supported by `evaluate_arithmetic()`
+/// are forwarded to ROOT's `TFormula` if `SDC_TFORMULA_FALLBACK` is enabled.
 ///
 ///\ingroup utils
-template<> SDC_INLINE float
-lexical_cast<float>(const std::string & strexpr) SDC_ENDDECL
+SDC_INLINE double
+eval_arithmetic_expression(std::string_view strexpr) SDC_ENDDECL
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
 {
-    if( is_numeric_literal(strexpr) ) {
-        try {
-            return std::stof(strexpr);
-        } catch( const std::invalid_argument & ) {
-            throw errors::ParserError( "stof(): no conversion can be performed"
-                                     , strexpr );
-        } catch( const std::out_of_range & ) {
-            throw errors::ParserError( "stof(): out of range", strexpr);
+    static thread_local std::unordered_map<std::string, double> cache;
+    static thread_local std::string key;  // re-used lookup key
+    key.assign(strexpr.data(), strexpr.size());
+    auto it = cache.find(key);
+    if( cache.end() != it ) return it->second;
+    double r;
+    #if (!defined(SDC_NO_ROOT)) && SDC_TFORMULA_FALLBACK
+    try {
+        r = evaluate_arithmetic(strexpr);
+    } catch( const errors::ParserError & ) {
+        // try to directly evaluate arithmetic expression using TFormula
+        TFormula f("tmpFormula", key.c_str());
+        #if defined(SDC_TFORMULA_VALIDATION) && SDC_TFORMULA_VALIDATION
+        if( ! f.IsValid() ) {
+            throw errors::ParserError( "invalid numerical literal, formula, or"
+                    " arithmetic expression", key);
         }
+        #endif
+        r = f.Eval(0.);
     }
-    #ifdef SDC_NO_ROOT
-    throw errors::ParserError( "expression does not match a numeric literal pattern"
-            , strexpr );
     #else
-    // try to directly evaluate arithmetic expression using TFormula
-    TFormula f("tmpFormula", strexpr.c_str());
-    #if defined(SDC_TFORMULA_VALIDATION) && SDC_TFORMULA_VALIDATION
-    if( ! f.IsValid() ) {
-        throw errors::ParserError( "invalid numerical literal, formula, or"
-                " arithmetic expression", strexpr);
-    }
+    r = evaluate_arithmetic(strexpr);
     #endif
-    const double r = f.Eval(0.);
+    if( cache.size() >= 4096 ) cache.clear();  // keep memory bounded
+    cache.emplace(key, r);
     return r;
-    #endif
+}
+#endif
+
+/**\brief Converts string to arithmetic type, throws on failure
+ *
+ * Exception-raising wrapper over `parse_numeric()`. For floating point types
+ * expression which is not a numeric literal is forwarded to
+ * `eval_arithmetic_expression()`.
+ *
+ * \throws `errors::ParserError` if string can not be converted
+ *
+ * \ingroup utils
+ * */
+template<typename T> T
+numeric_cast( std::string_view strexpr ) {
+    T r;
+    const std::errc ec = parse_numeric(strexpr, r);
+    if( std::errc() == ec ) return r;
+    if( std::errc::result_out_of_range == ec ) {
+        throw errors::ParserError( "numeric value out of range"
+                                 , std::string(strexpr) );
+    }
+    if constexpr (std::is_floating_point<T>::value) {
+        return static_cast<T>(eval_arithmetic_expression(strexpr));
+    } else {
+        throw errors::ParserError( "expression is not an integer literal"
+                                 , std::string(strexpr) );
+    }
+}
+
+///\brief Lexical cast traits; define to-/from- string conversions for various types
+///
+///\ingroup utils
+template<typename T, class=void> struct LexicalTraits;
+
+///\brief SDC's function for lexical cast. Meant to be used with specializations
+///
+///\ingroup utils
+template<typename T> T lexical_cast(const std::string & s);
+
+///\brief Specialization for STL string (trivial)
+///
+///\ingroup utils
+template<> SDC_INLINE std::string
+lexical_cast<std::string>(const std::string & s) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    return s;
+}
+#endif
+
+///\brief Specialization for boolean value
+///
+///\ingroup utils
+template<> SDC_INLINE bool
+lexical_cast<bool>(const std::string & strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    static const std::set<std::string> trueLiterals
+        = { "True", "true", "TRUE", "yes", "1" },
+        falseLiterals = { "False", "false", "FALSE", "no", "0" };
+
+    auto it = trueLiterals.find(strexpr);
+    if( it != trueLiterals.end() ) return true;
+    it = falseLiterals.find(strexpr);
+    if( it != falseLiterals.end() ) return false;
+
+    throw errors::ParserError( "expression does not look like boolean literal"
+            , strexpr );
+}
+#endif
+
+///\brief Specialization for standard signed integer
+///
+///\ingroup utils
+template<> SDC_INLINE int
+lexical_cast<int>(const std::string & strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    return numeric_cast<int>(strexpr);
+}
+#endif
+
+///\brief Specialization for long unsigned integer
+///
+///\ingroup utils
+template<> SDC_INLINE unsigned long
+lexical_cast<unsigned long>(const std::string & strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    return numeric_cast<unsigned long>(strexpr);
+}
+#endif
+
+///\brief Specialization for long unsigned integer
+///
+///\ingroup utils
+template<> SDC_INLINE long int
+lexical_cast<long int>(const std::string & strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    return numeric_cast<long int>(strexpr);
+}
+#endif
+
+///\brief Specialization for single-precision floating point number (supports
+///       arithmetics)
+///
+///\ingroup utils
+template<> SDC_INLINE float
+lexical_cast<float>(const std::string & strexpr) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    return numeric_cast<float>(strexpr);
 }
 #endif
 
@@ -1051,32 +1857,7 @@ template<> SDC_INLINE double
 lexical_cast<double>(const std::string & strexpr) SDC_ENDDECL
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
 {
-    if( is_numeric_literal(strexpr) ) {
-        try {
-            return std::stod(strexpr);
-        } catch( const std::invalid_argument & ) {
-            throw errors::ParserError( "stod(): no conversion can be performed"
-                                     , strexpr );
-        } catch( const std::out_of_range & ) {
-            throw errors::ParserError( "stod(): out of range", strexpr);
-        }
-    }
-    #ifdef SDC_NO_ROOT
-    throw errors::ParserError( "expression does not match a numeric literal pattern"
-            , strexpr );
-    #else
-    // try to directly evaluate arithmetic expression using TFormula
-    TFormula * f = new TFormula("tmpFormula", strexpr.c_str());
-    #if defined(SDC_TFORMULA_VALIDATION) && SDC_TFORMULA_VALIDATION
-    if( ! f->IsValid() ) {
-        throw errors::ParserError( "invalid numerical literal, formula, or"
-                " arithmetic expression", strexpr);
-    }
-    #endif
-    const double r = f->Eval(0.);
-    delete f;
-    return r;
-    #endif
+    return numeric_cast<double>(strexpr);
 }
 #endif
 
@@ -1169,6 +1950,34 @@ struct Value : public std::string {
     }
 };
 
+///\brief Lexical cast of the string view
+///
+/// Arithmetic types and strings are converted directly from the view, other
+/// types are forwarded to `lexical_cast<>()`.
+///
+///\ingroup utils
+template<typename T> T lexical_cast_view(std::string_view s) {
+    if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value) {
+        return numeric_cast<T>(s);
+    } else if constexpr (std::is_same<T, std::string_view>::value) {
+        return s;
+    } else if constexpr (std::is_same<T, std::string>::value) {
+        return std::string(s);
+    } else {
+        return lexical_cast<T>(std::string(s));
+    }
+}
+
+///\brief An object wrapper over `lexical_cast_view<>()`
+///
+///\ingroup utils
+struct ValueView : public std::string_view {
+    ValueView(std::string_view s) : std::string_view(s) {}
+    template<typename T> operator T() const {
+        return lexical_cast_view<T>(*this);
+    }
+};
+
 
 ///\brief For given key finds a range of "most recent" entries
 ///
@@ -1233,6 +2042,31 @@ struct ColumnsOrder : public std::unordered_map<std::string, int> {
         }
     };  // class CSVLine
 
+    /// Columns of the tokenized line, referring to the tokens
+    ///
+    /// Same as `CSVLine`, but keeps tokens as string views, so neither map
+    /// nor strings are created per line. Refers to the `ColumnsOrder`
+    /// instance it was created with.
+    struct CSVLineView {
+        const ColumnsOrder * order;
+        Tokens tokens;
+
+        /// Returns a token with given semantics (column name) or throws an error
+        ValueView operator()(const std::string & name) const {
+            auto it = order->find(name);
+            if( order->end() == it )
+                throw errors::NoColumnDefinedForTable(name);
+            return tokens[it->second];
+        }
+        /// Returns a parsed value with given semantics or default one
+        template<typename T>
+        T operator()(const std::string & name, const T & default_) const {
+            auto it = order->find(name);
+            if( order->end() == it ) return default_;
+            return lexical_cast_view<T>(tokens[it->second]);
+        }
+    };  // class CSVLineView
+
     #if 0
     /// Checks that parsed columns all are from certain set
     ColumnsOrder & validate( const std::set<std::string> & allowed ) {
@@ -1243,27 +2077,57 @@ struct ColumnsOrder : public std::unordered_map<std::string, int> {
     }
     #endif
 
-    CSVLine interpret(const std::list<std::string> & toks_, LoadLog * loadLogPtr=nullptr);
+    CSVLine interpret(const std::list<std::string> & toks_, LoadLog * loadLogPtr=nullptr) const;
+
+    ///\brief Interprets tokens produced by `tokenize_view()`
+    ///
+    /// Returned object refers to this columns order, so it can not be called
+    /// on temporary (use `MetaInfo::get_ref()` to obtain columns order from
+    /// metadata).
+    CSVLineView interpret(Tokens toks, LoadLog * loadLogPtr=nullptr) const &;
+    CSVLineView interpret(Tokens toks, LoadLog * loadLogPtr=nullptr) const && = delete;
+private:
+    [[noreturn]] static void _throw_mismatch(int nCol, const std::string & name, size_t nToks);
 };
 
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+SDC_INLINE void
+ColumnsOrder::_throw_mismatch(int nCol, const std::string & name, size_t nToks) {
+    char errBuf[256];
+    snprintf(errBuf, sizeof(errBuf)
+            , "Columns number mismatch; no column #%d expected"
+            " for \"%s\" in current line (has only %zu columns)"
+            , nCol + 1, name.c_str(), nToks
+            );
+    throw errors::ParserError(errBuf);
+}
+
+SDC_INLINE ColumnsOrder::CSVLineView
+ColumnsOrder::interpret(Tokens toks, LoadLog * loadLogPtr) const & {
+    for( const auto & meaning : *this ) {
+        if(toks.size() <= (unsigned int) meaning.second)
+            _throw_mismatch(meaning.second, meaning.first, toks.size());
+        if(!loadLogPtr) continue;
+        loadLogPtr->add_entry(meaning.first, std::string(toks[meaning.second]));
+    }
+    return CSVLineView{this, std::move(toks)};
+}
+#endif
+
 #if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
 SDC_INLINE ColumnsOrder::CSVLine
-ColumnsOrder::interpret(const std::list<std::string> & toks_, LoadLog * loadLogPtr) {
-    std::vector<std::string> toks(toks_.begin(), toks_.end());
+ColumnsOrder::interpret(const std::list<std::string> & toks_, LoadLog * loadLogPtr) const {
+    // index tokens (temporary lives in current load's arena, if any)
+    ArenaVector<const std::string *> toks;
+    toks.reserve(toks_.size());
+    for( const auto & tok : toks_ ) toks.push_back(&tok);
     CSVLine l;
     for( const auto & meaning : *this ) {
-        if(toks.size() <= (unsigned int) meaning.second) {
-            char errBuf[256];
-            snprintf(errBuf, sizeof(errBuf)
-                    , "Columns number mismatch; no column #%d expected"
-                    " for \"%s\" in current line (has only %zu columns)"
-                    , meaning.second + 1, meaning.first.c_str(), toks.size()
-                    );
-            throw errors::ParserError(errBuf);
-        }
-        l[meaning.first] = toks[meaning.second];
+        if(toks.size() <= (unsigned int) meaning.second)
+            _throw_mismatch(meaning.second, meaning.first, toks.size());
+        l[meaning.first] = *toks[meaning.second];
         if(!loadLogPtr) continue;
-        loadLogPtr->add_entry(meaning.first, toks[meaning.second]);
+        loadLogPtr->add_entry(meaning.first, *toks[meaning.second]);
     }
     return l;
 }
@@ -1667,57 +2531,858 @@ FS::~FS() {
 }
 #endif
 
-//                                                              _______________
-// ___________________________________________________________/ Metadata Index
+//                                                            _________________
+// _________________________________________________________/ Document Reading
 
-///\brief A dictionary of file's meta information
-///
-/// Provides indexing and caching utilities to keep and retrieve metadata
-/// entries of various types. Caches results to avoid re-creation of the
-/// complex types (like TFormula).
-///
-///\ingroup indexing
-struct MetaInfo
-    : protected std::unordered_multimap< std::string
-                                       , std::pair<size_t, std::string>
-                                       > {
+/**\brief Restart point within compressed document
+ *
+ * Decompressor state sufficient to start decompression in the middle of the
+ * compressed document: position in both compressed and decompressed streams
+ * and the dictionary (history window) preceding it. For gzip documents these
+ * points are set on deflate block boundaries, so `bits` denotes number of
+ * bits of the byte preceding `inOffset` that belong to the next block.
+ *
+ * \ingroup utils
+ * */
+struct RestartPoint {
+    /// Offset within decompressed content
+    size_t offset;
+    /// Offset within compressed content
+    size_t inOffset;
+    /// Number of bits of the preceding compressed byte to be used
+    int bits;
+    /// Decompressed data preceding the point (up to 32 kB)
+    std::string window;
+};
+
+/**\brief Cache of decompressed documents content
+ *
+ * Documents compressed with xz or zstd have no restart points, so reading
+ * any of their blocks requires decompression of the entire document. To not
+ * repeat it for every block read, `MappedDocument` keeps decompressed content
+ * of such documents in this (process-wide) cache. Entries are validated by
+ * file's device, inode, size and modification time; least recently used
+ * ones are evicted when memory budget is exceeded. Thread-safe.
+ *
+ * \ingroup utils
+ * */
+class DecompressedCache {
 public:
-    typedef std::unordered_multimap< std::string
-                                   , std::pair<size_t, std::string>
-                                   > Parent;
+    /// Default memory budget, bytes
+    static constexpr size_t defaultBudget = 256*1024*1024;
+    /// Cached content
+    typedef std::shared_ptr<const std::string> Content;
 private:
-    /// Key for metainfo value cache
-    typedef std::tuple<std::string, size_t, const std::type_info &> CacheKey;
-    /// Hashing function for cache value
-    struct CacheKeyHash
-            /*: public std::unary_function<CacheKey, std::size_t>*/ {
-        std::size_t operator()(const CacheKey & k) const {
-            return std::hash<std::string>{}(std::get<0>(k))
-                 ^ (std::get<1>(k) << 1)
-                 ^ (std::get<2>(k).hash_code() >> 1);
-        }
-    };
-    /// Basic cache entry
-    struct BaseMetaInfoCache { virtual ~BaseMetaInfoCache(){} };
-    /// Specialized cache entry
-    template<typename T> struct MetaInfoCachedValue : public BaseMetaInfoCache {
-        T value;
-        MetaInfoCachedValue(const std::string & strv) : value(aux::lexical_cast<T>(strv)) {}
+    struct Entry {
+        std::string path;
+        dev_t dev;
+        ino_t ino;
+        off_t size;
+        struct timespec mtime;
+        Content content;
     };
-private:
-    /// A dictionary of cached metainfo values
-    mutable std::unordered_map< CacheKey
-                              , std::shared_ptr<BaseMetaInfoCache>
-                              , CacheKeyHash
-                              > _cache;
-    /// Dictionary of MD aliases
-    ///
-    /// Mapping is from alias to "true" name (one to many)
-    std::unordered_map<std::string, std::string> _aliases;
-    /// Dictionary of reverse aliases
-    ///
-    /// Mapping is from "true" name to alias (many to one)
+    typedef std::list<Entry> LRUList;
+    LRUList _lru;
+    std::unordered_map<std::string, LRUList::iterator> _index;
+    size_t _budget, _nBytes, _nHits, _nMisses;
+    mutable std::mutex _mtx;
+
+    static bool _same( const Entry & e, const struct stat & st ) {
+        return e.dev == st.st_dev && e.ino == st.st_ino && e.size == st.st_size
+            && e.mtime.tv_sec == st.st_mtim.tv_sec
+            && e.mtime.tv_nsec == st.st_mtim.tv_nsec;
+    }
+    void _erase( LRUList::iterator it ) {
+        _nBytes -= it->content->size();
+        _index.erase(it->path);
+        _lru.erase(it);
+    }
+public:
+    explicit DecompressedCache( size_t budget=defaultBudget )
+        : _budget(budget), _nBytes(0), _nHits(0), _nMisses(0) {}
+
+    /// Returns content of the file, if cached and file was not changed
+    Content get( const std::string & path, const struct stat & st ) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto it = _index.find(path);
+        if( _index.end() == it ) { ++_nMisses; return nullptr; }
+        if( !_same(*it->second, st) ) {
+            _erase(it->second);
+            ++_nMisses;
+            return nullptr;
+        }
+        _lru.splice(_lru.begin(), _lru, it->second);
+        ++_nHits;
+        return it->second->content;
+    }
+    /// Keeps content of the file, evicting least recently used entries
+    void put( const std::string & path, const struct stat & st, Content content ) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto it = _index.find(path);
+        if( _index.end() != it ) _erase(it->second);
+        if( content->size() > _budget ) return;
+        while( !_lru.empty() && _nBytes + content->size() > _budget )
+            _erase(std::prev(_lru.end()));
+        _lru.push_front(Entry{path, st.st_dev, st.st_ino, st.st_size, st.st_mtim, content});
+        _index.emplace(path, _lru.begin());
+        _nBytes += content->size();
+    }
+    /// Sets memory budget (zero disables caching), evicting entries if need
+    void set_budget( size_t budget ) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _budget = budget;
+        while( !_lru.empty() && _nBytes > _budget ) _erase(std::prev(_lru.end()));
+    }
+    /// Drops all the entries
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mtx);
+        while( !_lru.empty() ) _erase(_lru.begin());
+    }
+
+    size_t budget() const { std::lock_guard<std::mutex> lock(_mtx); return _budget; }
+    size_t n_bytes() const { std::lock_guard<std::mutex> lock(_mtx); return _nBytes; }
+    size_t n_hits() const { std::lock_guard<std::mutex> lock(_mtx); return _nHits; }
+    size_t n_misses() const { std::lock_guard<std::mutex> lock(_mtx); return _nMisses; }
+
+    /// Returns cache used by `MappedDocument`
+    static DecompressedCache & instance();
+};
+
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+SDC_INLINE DecompressedCache &
+DecompressedCache::instance() {
+    static DecompressedCache cache;
+    return cache;
+}
+#endif
+
+/**\brief Read-only memory-mapped document
+ *
+ * Maps the file content into memory to be read without copying. Files
+ * smaller than `minMappedSize` and ones that can not be mapped (pipes,
+ * character devices, etc) are read into heap buffer instead.
+ *
+ * \warning Mapped file must not be truncated while the document is read:
+ *          access to the pages beyond the new end of file raises `SIGBUS`.
+ *          Files shall be replaced atomically (written to temporary file
+ *          and renamed over the original), not modified in place.
+ *
+ * Compressed documents are transparently decompressed into heap buffer.
+ * Compression is recognized by magic bytes: gzip (unless `SDC_NO_ZLIB` is
+ * defined), xz (unless `SDC_NO_LZMA` is defined) and zstd (unless
+ * `SDC_NO_ZSTD` is defined) are supported. For gzip
+ * documents, restart points can be collected during decompression (if
+ * `restartSpan` is non-zero, a point is set every `restartSpan` bytes at
+ * most) and used later to decompress only the document's tail, starting from
+ * certain point. Then `content()` refers to the tail, starting at
+ * `base_offset()` of the entire decompressed document. Restart points are
+ * not supported for xz and zstd; decompressed content of such documents is
+ * kept in `DecompressedCache` instead, so that documents are not
+ * decompressed for every block read (while they fit the cache budget).
+ *
+ * \throws `errors::IOError` if file can not be opened, read or decompressed.
+ * \ingroup utils
+ * */
+class MappedDocument {
+public:
+    /// Compression formats recognized by magic bytes
+    enum Compression { kPlain, kGzip, kXz, kZstd };
+    /// Files smaller than this are read rather than mapped, bytes
+    static constexpr size_t minMappedSize = 64*1024;
+private:
+    /// Pointer to the document content
+    const char * _data;
+    /// Size of the document content, bytes
+    size_t _size;
+    /// Buffer used if document can not be mapped or is compressed
+    std::string _buffer;
+    /// Whether `_data` is a mapped region
+    bool _mapped;
+    /// Compression of the document file
+    Compression _compression;
+    /// Offset of the content within entire (decompressed) document
+    size_t _base;
+    /// Restart points collected during decompression
+    std::vector<std::shared_ptr<const RestartPoint>> _restartPoints;
+    /// Decompressed content shared with `DecompressedCache`, if any
+    DecompressedCache::Content _shared;
+
+    void _release();
+    void _inflate_gzip( const std::string & path, std::string_view in
+                      , const RestartPoint * from, size_t restartSpan );
+    void _decompress_xz( const std::string & path, std::string_view in );
+    void _decompress_zstd( const std::string & path, std::string_view in );
+public:
+    /// Opens document, (optionally) decompressing it starting from
+    /// the given restart point and collecting restart points
+    MappedDocument( const std::string & path
+                  , const RestartPoint * from=nullptr
+                  , size_t restartSpan=0
+                  );
+    MappedDocument(const MappedDocument &) = delete;
+    MappedDocument & operator=(const MappedDocument &) = delete;
+    ~MappedDocument();
+
+    /// Returns view on the document content
+    std::string_view content() const { return std::string_view(_data, _size); }
+    /// Returns offset of the content within entire document
+    size_t base_offset() const { return _base; }
+    /// Returns compression of the document file
+    Compression compression() const { return _compression; }
+    /// Returns restart points collected during decompression
+    const std::vector<std::shared_ptr<const RestartPoint>> & restart_points() const
+        { return _restartPoints; }
+    /// Returns last restart point preceding the given offset, if any
+    std::shared_ptr<const RestartPoint> restart_point_for( size_t offset ) const;
+
+    /// Recognizes compression by leading bytes of the content
+    static Compression compression_of( std::string_view content );
+};
+
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+SDC_INLINE
+MappedDocument::MappedDocument( const std::string & path
+                              , const RestartPoint * from
+                              , size_t restartSpan
+                              )
+        : _data(nullptr), _size(0), _mapped(false)
+        , _compression(kPlain), _base(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if( fd < 0 ) {
+        throw errors::IOError(path, std::string("could not open file: ")
+                + strerror(errno));
+    }
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    const bool isRegular = 0 == fstat(fd, &st) && S_ISREG(st.st_mode);
+    if( isRegular ) {
+        _size = st.st_size;
+        if( _size >= minMappedSize ) {
+            void * p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if( MAP_FAILED != p ) {
+                _data = static_cast<const char *>(p);
+                _mapped = true;
+            }
+        }
+    }
+    if( !_mapped && (_size || !isRegular) ) {
+        // not a regular file, small one or mapping failed -- read content
+        // in buffer
+        _buffer.reserve(_size);
+        char bf[4096];
+        ssize_t nRead;
+        while( (nRead = ::read(fd, bf, sizeof(bf))) > 0 ) {
+            _buffer.append(bf, nRead);
+        }
+        if( nRead < 0 ) {
+            int readErrNo = errno;
+            ::close(fd);
+            throw errors::IOError(path, std::string("could not read file: ")
+                    + strerror(readErrNo));
+        }
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+    ::close(fd);  // mapping (if any) remains valid
+    _compression = compression_of(content());
+    if( kPlain == _compression ) return;
+    // documents without restart points are decompressed entirely, so
+    // decompressed content is cached
+    const bool cacheable = isRegular && (kXz == _compression || kZstd == _compression);
+    if( cacheable ) {
+        _shared = DecompressedCache::instance().get(path, st);
+        if( _shared ) {
+            _release();
+            std::string().swap(_buffer);
+            _data = _shared->data();
+            _size = _shared->size();
+            return;
+        }
+    }
+    try {
+        switch( _compression ) {
+            case kGzip:
+                _inflate_gzip(path, content(), from, restartSpan);
+                break;
+            case kXz:
+                _decompress_xz(path, content());
+                break;
+            case kZstd:
+                _decompress_zstd(path, content());
+                break;
+            default:
+                break;
+        };
+    } catch( ... ) {
+        _release();
+        throw;
+    }
+    if( cacheable ) {
+        _shared = std::make_shared<const std::string>(std::move(_buffer));
+        _data = _shared->data();
+        _size = _shared->size();
+        DecompressedCache::instance().put(path, st, _shared);
+    }
+}
+
+SDC_INLINE
+MappedDocument::~MappedDocument() {
+    _release();
+}
+
+SDC_INLINE void
+MappedDocument::_release() {
+    if( _mapped ) munmap(const_cast<char *>(_data), _size);
+    _mapped = false;
+}
+
+SDC_INLINE MappedDocument::Compression
+MappedDocument::compression_of( std::string_view c ) {
+    if( c.size() >= 2 && c.compare(0, 2, "\x1f\x8b", 2) == 0 ) return kGzip;
+    if( c.size() >= 6 && c.compare(0, 6, "\xfd" "7zXZ\0", 6) == 0 ) return kXz;
+    if( c.size() >= 4 && c.compare(0, 4, "\x28\xb5\x2f\xfd", 4) == 0 ) return kZstd;
+    return kPlain;
+}
+
+SDC_INLINE std::shared_ptr<const RestartPoint>
+MappedDocument::restart_point_for( size_t offset ) const {
+    auto it = std::upper_bound( _restartPoints.begin(), _restartPoints.end()
+            , offset
+            , []( size_t o, const std::shared_ptr<const RestartPoint> & p ) {
+                return o < p->offset;
+            } );
+    if( it == _restartPoints.begin() ) return nullptr;
+    return *(--it);
+}
+
+SDC_INLINE void
+MappedDocument::_inflate_gzip( const std::string & path
+                             , std::string_view in
+                             , const RestartPoint * from
+                             , size_t restartSpan
+                             ) {
+    #ifndef SDC_NO_ZLIB
+    // Mode of zlib's `inflateInit2()`/`inflateReset2()`: 47 stands for
+    // automatic gzip/zlib header detection, -15 for raw deflate stream
+    // (one that is decompressed starting from restart point)
+    const int gzMode = 47, rawMode = -15;
+    const size_t windowSize = 32768;
+    std::string out;
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int mode = from ? rawMode : gzMode;
+    if( Z_OK != inflateInit2(&strm, mode) )
+        throw errors::IOError(path, "failed to initialize zlib stream");
+    size_t inPos = 0;
+    if( from ) {
+        inPos = from->inOffset;
+        if( inPos > in.size() || (from->bits && !inPos) ) {
+            inflateEnd(&strm);
+            throw errors::IOError(path, "restart point is out of compressed"
+                    " data (file changed?)");
+        }
+        if( from->bits ) {
+            inflatePrime( &strm, from->bits
+                        , static_cast<unsigned char>(in[inPos - 1]) >> (8 - from->bits) );
+        }
+        if( !from->window.empty() )
+            inflateSetDictionary( &strm
+                    , reinterpret_cast<const Bytef *>(from->window.data())
+                    , from->window.size() );
+        _base = from->offset;
+    }
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data() + inPos));
+    // zlib's input size is 32-bit, so input is fed by chunks; `avail_in`
+    // is zero only when input is exhausted
+    const char * const inEnd = in.data() + in.size();
+    auto feed = [&strm, inEnd]() {
+        const size_t nLeft = inEnd - reinterpret_cast<const char *>(strm.next_in);
+        strm.avail_in = nLeft < std::numeric_limits<uInt>::max()
+                      ? static_cast<uInt>(nLeft)
+                      : std::numeric_limits<uInt>::max();
+    };
+    feed();
+    size_t lastPoint = 0;
+    char chunk[65536];
+    for(;;) {
+        strm.next_out = reinterpret_cast<Bytef *>(chunk);
+        strm.avail_out = sizeof(chunk);
+        int rc = inflate(&strm, Z_BLOCK);
+        out.append(chunk, sizeof(chunk) - strm.avail_out);
+        feed();
+        if( Z_OK != rc && Z_STREAM_END != rc && Z_BUF_ERROR != rc ) {
+            std::string details = strm.msg ? strm.msg : "inflate() failed";
+            inflateEnd(&strm);
+            throw errors::IOError(path, "gzip decompression error: " + details);
+        }
+        if( Z_STREAM_END == rc ) {
+            if( rawMode == mode ) {
+                // raw stream ends before gzip trailer; skip it
+                const uInt nSkip = strm.avail_in < 8 ? strm.avail_in : 8;
+                strm.next_in += nSkip;
+                feed();
+            }
+            if( !strm.avail_in ) break;
+            // concatenated gzip member follows
+            mode = gzMode;
+            inflateReset2(&strm, mode);
+            continue;
+        }
+        if( Z_BUF_ERROR == rc && !strm.avail_in ) {
+            inflateEnd(&strm);
+            throw errors::IOError(path, "gzip decompression error: unexpected"
+                    " end of compressed data");
+        }
+        // at the end of deflate block header? (but not the last block)
+        if( restartSpan && (strm.data_type & 128) && !(strm.data_type & 64)
+         && out.size() - lastPoint >= restartSpan ) {
+            const size_t nWin = out.size() < windowSize ? out.size() : windowSize;
+            _restartPoints.push_back(std::make_shared<RestartPoint>(RestartPoint{
+                      _base + out.size()
+                    , static_cast<size_t>(reinterpret_cast<const char *>(strm.next_in) - in.data())
+                    , strm.data_type & 7
+                    , out.substr(out.size() - nWin)
+                    }));
+            lastPoint = out.size();
+        }
+    }
+    inflateEnd(&strm);
+    _release();
+    _buffer.swap(out);
+    _data = _buffer.data();
+    _size = _buffer.size();
+    #else
+    (void) in; (void) from; (void) restartSpan;
+    throw errors::IOError(path, "gzip compression is not supported (SDC is"
+            " built without zlib)");
+    #endif
+}
+
+SDC_INLINE void
+MappedDocument::_decompress_xz( const std::string & path, std::string_view in ) {
+    #ifndef SDC_NO_LZMA
+    std::string out;
+    lzma_stream strm = LZMA_STREAM_INIT;
+    if( LZMA_OK != lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) )
+        throw errors::IOError(path, "failed to initialize lzma stream");
+    strm.next_in = reinterpret_cast<const uint8_t *>(in.data());
+    strm.avail_in = in.size();
+    char chunk[65536];
+    lzma_ret rc;
+    do {
+        strm.next_out = reinterpret_cast<uint8_t *>(chunk);
+        strm.avail_out = sizeof(chunk);
+        rc = lzma_code(&strm, strm.avail_in ? LZMA_RUN : LZMA_FINISH);
+        out.append(chunk, sizeof(chunk) - strm.avail_out);
+    } while( LZMA_OK == rc );
+    lzma_end(&strm);
+    if( LZMA_STREAM_END != rc ) {
+        throw errors::IOError(path, "xz decompression error (code "
+                + std::to_string(rc) + ")");
+    }
+    _release();
+    _buffer.swap(out);
+    _data = _buffer.data();
+    _size = _buffer.size();
+    #else
+    (void) in;
+    throw errors::IOError(path, "xz compression is not supported (SDC is"
+            " built without liblzma)");
+    #endif
+}
+
+SDC_INLINE void
+MappedDocument::_decompress_zstd( const std::string & path, std::string_view in ) {
+    #ifndef SDC_NO_ZSTD
+    std::string out;
+    ZSTD_DStream * strm = ZSTD_createDStream();
+    if( !strm || ZSTD_isError(ZSTD_initDStream(strm)) ) {
+        ZSTD_freeDStream(strm);
+        throw errors::IOError(path, "failed to initialize zstd stream");
+    }
+    ZSTD_inBuffer inBuf = { in.data(), in.size(), 0 };
+    char chunk[65536];
+    // zero when frame is complete (next frame, if any, follows)
+    size_t rc = 0;
+    while( inBuf.pos < inBuf.size || rc ) {
+        ZSTD_outBuffer outBuf = { chunk, sizeof(chunk), 0 };
+        const size_t inPos = inBuf.pos;
+        rc = ZSTD_decompressStream(strm, &outBuf, &inBuf);
+        if( ZSTD_isError(rc) ) {
+            const std::string details = ZSTD_getErrorName(rc);
+            ZSTD_freeDStream(strm);
+            throw errors::IOError(path, "zstd decompression error: " + details);
+        }
+        out.append(chunk, outBuf.pos);
+        if( rc && inBuf.pos == inPos && !outBuf.pos ) {
+            ZSTD_freeDStream(strm);
+            throw errors::IOError(path, "zstd decompression error: unexpected"
+                    " end of compressed data");
+        }
+    }
+    ZSTD_freeDStream(strm);
+    _release();
+    _buffer.swap(out);
+    _data = _buffer.data();
+    _size = _buffer.size();
+    #else
+    (void) in;
+    throw errors::IOError(path, "zstd compression is not supported (SDC is"
+            " built without libzstd)");
+    #endif
+}
+#endif
+
+/**\brief Computes hash of the file content
+ *
+ * 64-bit FNV-1a hash of the raw (not decompressed) file content, used to
+ * detect document changes.
+ *
+ * \throws `errors::IOError` if file can not be opened or read.
+ * \ingroup utils
+ * */
+SDC_INLINE uint64_t
+file_hash( const std::string & path ) SDC_ENDDECL
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if( fd < 0 ) {
+        throw errors::IOError(path, std::string("could not open file: ")
+                + strerror(errno));
+    }
+    uint64_t h = 14695981039346656037ULL;
+    unsigned char bf[65536];
+    ssize_t nRead;
+    while( (nRead = ::read(fd, bf, sizeof(bf))) > 0 ) {
+        for( ssize_t i = 0; i < nRead; ++i ) {
+            h ^= bf[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    int readErrNo = errno;
+    ::close(fd);
+    if( nRead < 0 ) {
+        throw errors::IOError(path, std::string("could not read file: ")
+                + strerror(readErrNo));
+    }
+    return h;
+}
+#endif
+
+/**\brief Iterates over lines of in-memory document
+ *
+ * Yields views on the document lines (without trailing newline) keeping track
+ * on the line number and byte offset of each line. Does not copy the data.
+ *
+ * Content may be only a tail of the document, starting at `base` offset (as
+ * for compressed document decompressed from restart point); offsets are
+ * then given with respect to entire document.
+ *
+ * \ingroup utils
+ * */
+class LineReader {
+private:
+    std::string_view _doc;
+    size_t _base;
+    size_t _pos;
+    size_t _lineNo;
+public:
+    /// Creates reader positioned at certain line start; `lineNo` is the
+    /// number of the line preceding the one at `offset` (offsets preceding
+    /// `base` refer to content start)
+    LineReader(std::string_view doc, size_t offset=0, size_t lineNo=0, size_t base=0)
+        : _doc(doc), _base(base), _pos(offset > base ? offset - base : 0)
+        , _lineNo(lineNo) {}
+
+    /// Repositions reader at certain line start
+    void seek(size_t offset, size_t lineNo) {
+        assert(offset >= _base);
+        _pos = offset - _base;
+        _lineNo = lineNo;
+    }
+
+    /// Retrieves next line; returns `false` at the end of the document
+    bool next(std::string_view & line, size_t & lineOffset) {
+        if( _pos >= _doc.size() ) return false;
+        lineOffset = _base + _pos;
+        const char * b = _doc.data() + _pos
+                 , * e = simd::find_char(b, _doc.data() + _doc.size(), '\n');
+        line = std::string_view(b, e - b);
+        _pos += line.size() + 1;
+        ++_lineNo;
+        return true;
+    }
+
+    /// Number of the last line returned by `next()`
+    size_t line_number() const { return _lineNo; }
+};
+
+///\brief Strips comments and surrounding spaces from the line view
+///
+/// Version of `strip_line()` operating on string views. Comments that do
+/// not extend to the end of the line can not be stripped by adjusting the
+/// view, so if `comment_f` returns such bounds, the line is copied into
+/// `scratch` and the view is set to refer to it.
+///
+///\ingroup utils
+template<typename CommentCallableT>
+void strip_line_view( std::string_view & line
+                    , std::string & scratch
+                    , CommentCallableT comment_f
+                    ) {
+    std::pair<size_t, size_t> commentBounds;
+    while( (commentBounds = comment_f(line)).first != std::string::npos ) {
+        assert( commentBounds.second != 0 );  // TODO: multiline comments
+        if( commentBounds.second == std::string::npos
+         || commentBounds.first + commentBounds.second >= line.size() ) {
+            line = line.substr(0, commentBounds.first);
+        } else {
+            // inline comment -- have to copy
+            scratch.assign(line.data(), line.size());
+            scratch.replace(commentBounds.first, commentBounds.second, "");
+            line = scratch;
+        }
+    }
+    line = trim_view(line);
+}
+
+//                                                            _________________
+// _________________________________________________________/ String Interning
+
+/**\brief Interned string handle
+ *
+ * Strings used as identifiers over and over again (data type names,
+ * document IDs, metadata keys) are kept in a process-wide table, once per
+ * distinct value. Atom refers to the table entry, so it is cheap to copy, and
+ * atoms are compared and hashed by address in constant time. Table entries
+ * are never released.
+ *
+ * Constructing an atom from a string consults per-thread view of the table
+ * first, so shared table is locked only when a thread meets the value for
+ * the first time.
+ *
+ * Since entries are never released, only strings being stored (index
+ * entries, metadata definitions) shall be interned. Queries by arbitrary
+ * string shall use `find()` that does not insert new entries.
+ *
+ * \ingroup utils
+ * */
+class Atom {
+private:
+    const std::string * _str;
+    /// Returns table entry for the string; inserts it if need and
+    /// `insert` is set, otherwise returns null for unknown string
+    static const std::string * _lookup(std::string_view s, bool insert);
+    static const std::string * _intern(std::string_view s) { return _lookup(s, true); }
+    explicit Atom(const std::string * entry) : _str(entry) {}
+public:
+    /// Hashing function for unordered containers
+    struct Hash {
+        std::size_t operator()(const Atom & a) const
+            { return std::hash<const void *>{}(a._str); }
+    };
+
+    /// Constructs atom of empty string
+    Atom() : _str(_intern(std::string_view())) {}
+    Atom(const std::string & s) : _str(_intern(s)) {}
+    Atom(const char * s) : _str(_intern(s)) {}
+    Atom(std::string_view s) : _str(_intern(s)) {}
+
+    /// Returns atom of the string if it was interned, empty otherwise
+    static std::optional<Atom> find(std::string_view s) {
+        const std::string * entry = _lookup(s, false);
+        if( !entry ) return std::nullopt;
+        return Atom(entry);
+    }
+
+    /// Returns interned string
+    const std::string & str() const { return *_str; }
+    operator const std::string & () const { return *_str; }
+    operator std::string_view () const { return *_str; }
+    const char * c_str() const { return _str->c_str(); }
+    size_t size() const { return _str->size(); }
+    bool empty() const { return _str->empty(); }
+
+    friend bool operator==(const Atom & a, const Atom & b) { return a._str == b._str; }
+    friend bool operator!=(const Atom & a, const Atom & b) { return a._str != b._str; }
+    /// Orders by string content (same order as for strings)
+    friend bool operator<(const Atom & a, const Atom & b)
+        { return a._str != b._str && *a._str < *b._str; }
+
+    // comparison with strings, by content (does not intern the string)
+    template<typename S> friend
+    typename std::enable_if<std::is_convertible<const S &, std::string_view>::value, bool>::type
+    operator==(const Atom & a, const S & s) { return std::string_view(*a._str) == std::string_view(s); }
+    template<typename S> friend
+    typename std::enable_if<std::is_convertible<const S &, std::string_view>::value, bool>::type
+    operator==(const S & s, const Atom & a) { return a == s; }
+    template<typename S> friend
+    typename std::enable_if<std::is_convertible<const S &, std::string_view>::value, bool>::type
+    operator!=(const Atom & a, const S & s) { return !(a == s); }
+    template<typename S> friend
+    typename std::enable_if<std::is_convertible<const S &, std::string_view>::value, bool>::type
+    operator!=(const S & s, const Atom & a) { return !(a == s); }
+
+    friend std::ostream & operator<<(std::ostream & os, const Atom & a)
+        { return os << *a._str; }
+};
+
+/// Result type `R` of the overloads for string-like types `S` (other than
+/// `Atom`), used by lookups to find the string without interning it
+template<typename S, typename R>
+using if_string_like_t = typename std::enable_if<
+        std::is_convertible<const S &, std::string_view>::value
+        && !std::is_same<S, Atom>::value, R>::type;
+
+#if (!defined(SDC_NO_IMPLEM)) || !SDC_NO_IMPLEM
+SDC_INLINE const std::string *
+Atom::_lookup(std::string_view s, bool insert) {
+    static thread_local std::unordered_map<std::string_view, const std::string *> local;
+    auto it = local.find(s);
+    if( local.end() != it ) return it->second;
+    // shared table is never destroyed to keep atoms valid till the very exit
+    static std::mutex * mtx = new std::mutex();
+    static std::unordered_map<std::string_view, const std::string *> * table
+            = new std::unordered_map<std::string_view, const std::string *>();
+    const std::string * p;
+    {
+        std::lock_guard<std::mutex> lock(*mtx);
+        auto tableIt = table->find(s);
+        if( table->end() != tableIt ) {
+            p = tableIt->second;
+        } else {
+            if( !insert ) return nullptr;
+            p = new std::string(s);
+            table->emplace(std::string_view(*p), p);
+        }
+    }
+    local.emplace(std::string_view(*p), p);
+    return p;
+}
+#endif
+
+//                                                              _______________
+// ___________________________________________________________/ Metadata Index
+
+///\brief A dictionary of file's meta information
+///
+/// Provides indexing and caching utilities to keep and retrieve metadata
+/// entries of various types. Caches results to avoid re-creation of the
+/// complex types (like TFormula).
+///
+///\ingroup indexing
+struct MetaInfo
+    : protected std::unordered_multimap< Atom
+                                       , std::pair<size_t, std::string>
+                                       , Atom::Hash
+                                       > {
+public:
+    typedef std::unordered_multimap< Atom
+                                   , std::pair<size_t, std::string>
+                                   , Atom::Hash
+                                   > Parent;
+private:
+    /// Key for metainfo value cache
+    typedef std::tuple<Atom, size_t, const std::type_info &> CacheKey;
+    /// Hashing function for cache value
+    struct CacheKeyHash
+            /*: public std::unary_function<CacheKey, std::size_t>*/ {
+        std::size_t operator()(const CacheKey & k) const {
+            return Atom::Hash{}(std::get<0>(k))
+                 ^ (std::get<1>(k) << 1)
+                 ^ (std::get<2>(k).hash_code() >> 1);
+        }
+    };
+    /// Basic cache entry
+    struct BaseMetaInfoCache { virtual ~BaseMetaInfoCache(){} };
+    /// Specialized cache entry
+    template<typename T> struct MetaInfoCachedValue : public BaseMetaInfoCache {
+        T value;
+        MetaInfoCachedValue(const std::string & strv) : value(aux::lexical_cast<T>(strv)) {}
+    };
+private:
+    /// A dictionary of cached metainfo values
+    mutable std::unordered_map< CacheKey
+                              , std::shared_ptr<BaseMetaInfoCache>
+                              , CacheKeyHash
+                              > _cache;
+    /// Dictionary of MD aliases
+    ///
+    /// Mapping is from alias to "true" name (one to many)
+    std::unordered_map<std::string, std::string> _aliases;
+    /// Dictionary of reverse aliases
+    ///
+    /// Mapping is from "true" name to alias (many to one)
     std::unordered_multimap<std::string, std::string> _revAliases;
+    /// Line number of current data row, provided as `@lineNo` entry
+    size_t _rowLineNo;
+    /// Textual `@lineNo` value and the line number it was formatted for
+    mutable std::string _rowLineNoStr;
+    mutable size_t _rowLineNoStrFor;
+    /// Cached value of `@lineNo` (of the type requested last)
+    mutable std::shared_ptr<BaseMetaInfoCache> _rowLineNoCache;
+    mutable size_t _rowLineNoCacheFor;
+
+    /// Key of the row line number entry
+    static const Atom & _row_key() {
+        static const Atom key("@lineNo");
+        return key;
+    }
+    /// Returns whether the name refers to the row line number entry
+    bool _is_row_key( const std::string & name ) const
+        { return noRow != _rowLineNo && name == _row_key().str(); }
+    /// Returns textual `@lineNo` value, formatting it if need
+    const std::string * _row_strexpr() const {
+        if( _rowLineNoStrFor != _rowLineNo ) {
+            char bf[32];
+            snprintf(bf, sizeof(bf), "%zu", _rowLineNo);
+            _rowLineNoStr = bf;
+            _rowLineNoStrFor = _rowLineNo;
+        }
+        return &_rowLineNoStr;
+    }
+    /// Returns `@lineNo` converted to certain type
+    template<typename T> const T &
+    _row_value() const {
+        auto p = dynamic_cast<MetaInfoCachedValue<T>*>(_rowLineNoCache.get());
+        if( !p ) {
+            _rowLineNoCache.reset(p = new MetaInfoCachedValue<T>(*_row_strexpr()));
+        } else if( _rowLineNoCacheFor != _rowLineNo ) {
+            p->value = aux::lexical_cast<T>(*_row_strexpr());
+        }
+        _rowLineNoCacheFor = _rowLineNo;
+        return p->value;
+    }
+
+    /// Returns entries of the key (not interning the key)
+    std::pair<Parent::const_iterator, Parent::const_iterator>
+    _entries( const std::string & name ) const {
+        const auto atom = Atom::find(name);
+        if( !atom ) return {end(), end()};
+        return equal_range(*atom);
+    }
+
+    /// Returns latest value of entry defined before certain line, if any
+    const std::string * _find_strexpr( const Atom & name
+                                     , size_t lineNo
+                                     , size_t * foundLineNo_
+                                     ) const {
+        if( noRow != _rowLineNo && name == _row_key() ) {
+            if( foundLineNo_ ) *foundLineNo_ = 0;
+            return _row_strexpr();
+        }
+        const std::string * found = nullptr;
+        size_t foundLineNo = 0;
+        auto eqr = equal_range(name);
+        for( auto it = eqr.first; it != eqr.second; ++it ) {
+            if( it->second.first > lineNo ) continue;
+            if( found && it->second.first <= foundLineNo ) continue;
+            found = &it->second.second;
+            foundLineNo = it->second.first;
+        }
+        if( found && foundLineNo_ ) *foundLineNo_ = foundLineNo;
+        return found;
+    }
 public:
     using Parent::iterator;
     using Parent::const_iterator;
@@ -1727,10 +3392,14 @@ public:
     using Parent::empty;
     using Parent::size;
 
-    MetaInfo() {}
+    /// Value of unset row line number
+    static constexpr size_t noRow = std::numeric_limits<size_t>::max();
 
-    /// Copies only the MD key/value pairs, cache is not copied
-    MetaInfo(const MetaInfo & o) : Parent(o) {}
+    MetaInfo() : _rowLineNo(noRow), _rowLineNoStrFor(noRow) {}
+
+    /// Copies only the MD key/value pairs, cache and row line number are
+    /// not copied
+    MetaInfo(const MetaInfo & o) : Parent(o), _rowLineNo(noRow), _rowLineNoStrFor(noRow) {}
     MetaInfo& operator=(const MetaInfo & o) {
       if (&o != this) { // skip self-assign
         clear();
@@ -1740,6 +3409,17 @@ public:
       return *this;
     }
 
+    ///\brief Sets line number of the data row, provided as `@lineNo` entry
+    ///
+    /// Entry is not stored, so neither entries nor value cache are modified
+    /// and setting it per row is cheap. `noRow` unsets it.
+    void set_row_line(size_t lineNo) {
+        _row_key();  // assures key is interned, for lookups
+        _rowLineNo = lineNo;
+    }
+    /// Returns line number of the data row, or `noRow`
+    size_t row_line() const { return _rowLineNo; }
+
     ///\brief Defines MD name alias
     bool define_alias(const std::string & aliasName, const std::string & trueName_) {
         std::string trueName = resolve_alias_if_need(trueName_);
@@ -1761,6 +3441,18 @@ public:
         return it->second;
     }
 
+    ///\brief Same as `resolve_alias_if_need()`, but does not copy the name
+    ///
+    /// Returned view refers either to the argument, or to the alias
+    /// definition.
+    std::string_view resolve_alias_view(std::string_view name) const {
+        if(_aliases.empty()) return name;
+        auto it = _aliases.find(std::string(name));
+        if(_aliases.end() == it)
+            return name;
+        return it->second;
+    }
+
     /// A parent container
     //typedef std::unordered_multimap< std::string
     //                               , std::pair<size_t, std::string>
@@ -1768,20 +3460,19 @@ public:
     /// Retrieves a value by key, returns map by line numbers
     std::map<size_t, std::string> operator[]( const std::string & name_ ) const {
         std::string name = resolve_alias_if_need(name_);
-        auto eqr = equal_range(name);
+        if( _is_row_key(name) ) return {{0, *_row_strexpr()}};
+        auto eqr = _entries(name);
         std::map<size_t, std::string> m;
         std::transform( eqr.first, eqr.second
                 , std::inserter(m, m.end())
-                , [](const std::pair< std::string
-                                    , std::pair<size_t, std::string> > &p
-                     ) {return p.second;}
+                , [](const Parent::value_type & p) {return p.second;}
                 );
         return m;
     }
 
     ///\brief Returns `false` if no such key exists for any line
     bool has(const std::string & name) const
-        { return end() != find(name); }
+        { return _is_row_key(name) || _entries(name).first != end(); }
 
     /// \brief Retrieves a value by key from the metadata (defined before
     /// certain line number)
@@ -1814,6 +3505,37 @@ public:
         return it->second;
     }
     
+    ///\brief Returns pointer to the value string defined before certain line
+    ///
+    /// Same as `get_strexpr()`, but returns null if there is no such entry.
+    /// Does not copy the entries, so it is cheap enough to be used per data
+    /// row.
+    const std::string * find_strexpr( const std::string & name_
+                                    , size_t lineNo=std::numeric_limits<size_t>::max()
+                                    , size_t * foundLineNo_=nullptr
+                                    ) const {
+        const auto name = Atom::find(resolve_alias_if_need(name_));
+        return name ? _find_strexpr(*name, lineNo, foundLineNo_) : nullptr;
+    }
+    /// Same as `find_strexpr()` for C string key
+    const std::string * find_strexpr( const char * name_
+                                    , size_t lineNo=std::numeric_limits<size_t>::max()
+                                    , size_t * foundLineNo_=nullptr
+                                    ) const {
+        return find_strexpr(std::string(name_), lineNo, foundLineNo_);
+    }
+    ///\brief Same as `find_strexpr()` for interned key
+    ///
+    /// Does not hash the key string (unless aliases are defined), so it is
+    /// preferable for the keys looked up per data row.
+    const std::string * find_strexpr( const Atom & name_
+                                    , size_t lineNo=std::numeric_limits<size_t>::max()
+                                    , size_t * foundLineNo_=nullptr
+                                    ) const {
+        if( !_aliases.empty() ) return find_strexpr(name_.str(), lineNo, foundLineNo_);
+        return _find_strexpr(name_, lineNo, foundLineNo_);
+    }
+
     ///\brief Retrieves a value by key from the metadata and performs lexical
     ///       cast.
     ///
@@ -1829,23 +3551,50 @@ public:
     template<typename T> T
     get( const std::string & name_
        , size_t lineNo=std::numeric_limits<size_t>::max() ) const {
+        return get_ref<T>(name_, lineNo);
+    }
+
+    ///\brief Retrieves a reference to the cached value of the metadata entry
+    ///
+    /// Same as `get()`, but does not copy neither the metadata entries nor
+    /// the cached value, so it is cheap enough to be used per data row.
+    /// Reference remains valid until the entry is dropped, or metadata object
+    /// is re-assigned or destroyed.
+    ///
+    /// \throws `sdc::errors::NoMetadataEntry` error if no values(s) found.
+    /// \throws `sdc::errors::NoCurrentMetadataEntry` if no value(s) found for line
+    template<typename T> const T &
+    get_ref( const std::string & name_
+           , size_t lineNo=std::numeric_limits<size_t>::max() ) const {
         size_t lFound = 0;
-        auto strexpr = this->get_strexpr(name_, lineNo, &lFound);
-        std::string name = resolve_alias_if_need(name_);
+        const auto name = Atom::find(resolve_alias_if_need(name_));
+        const std::string * strexpr = name
+                                    ? _find_strexpr(*name, lineNo, &lFound)
+                                    : nullptr;
+        if( !strexpr ) {
+            if( !name || end() == find(*name) ) {
+                // no metadata with such key is defined in file (at all)
+                throw errors::NoMetadataEntryInFile(name_);
+            }
+            // no metadata entry with such key defined in file (till this line)
+            throw errors::NoCurrentMetadataEntry(name_, lineNo);
+        }
+        if( noRow != _rowLineNo && *name == _row_key() )
+            return _row_value<T>();
         // try to retrieve the cache
-        const CacheKey k = CacheKey{name, lFound, typeid(T)};
+        const CacheKey k = CacheKey{*name, lFound, typeid(T)};
         auto cacheIt = _cache.find(k);
         if( _cache.end() == cacheIt ) {
             auto ir = _cache.emplace( k,
                 std::shared_ptr<BaseMetaInfoCache>(new MetaInfoCachedValue<T>(
-                        strexpr) ) );
+                        *strexpr) ) );
             assert(ir.second);
             cacheIt = ir.first;
         }
         #ifndef NDEBUG
         // in debug build, make sure we have same cached value
         assert( static_cast<MetaInfoCachedValue<T>*>(cacheIt->second.get())->value
-             == lexical_cast<T>(strexpr) );
+             == lexical_cast<T>(*strexpr) );
         #endif
         return static_cast<MetaInfoCachedValue<T>*>(cacheIt->second.get())->value;
     }
@@ -1877,27 +3626,29 @@ public:
     ///\brief Value setter for user code
     ///
     /// Sets the metadata value (string).
-    void set( const std::string & name_
-            , const std::string & value
+    void set( std::string_view name_
+            , std::string_view value
             , size_t lineNo=std::numeric_limits<size_t>::min()
             ) {
-        std::string name = resolve_alias_if_need(name_);
-        emplace(name, std::pair<size_t, std::string>(lineNo, value));
+        emplace( Atom(resolve_alias_view(name_))
+               , std::pair<size_t, std::string>(lineNo, std::string(value)) );
     }
 
-    void drop( const std::string & name
+    void drop( std::string_view name
              , size_t lineNo=std::numeric_limits<size_t>::min() ) {
         // drop() is not something one uses often, so sub-optimal performance
         // here should be fine...
         //std::erase_if(_cache, [&name](const auto & cacheItem {
         //                return std::get<0>(cacheItem.first) == name)
         //            }));
+        const auto atom = Atom::find(name);
+        if( !atom ) return;  // never defined
         for(auto it = _cache.begin(); it != _cache.end(); ) {
-            if(std::get<0>(it->first) == name) {
+            if(std::get<0>(it->first) == *atom) {
                 _cache.erase(it++);
             } else ++it;
         }
-        Parent::erase(name);
+        Parent::erase(*atom);
     }
 
     /// Dumps current MD content as JSON dictionary
@@ -1920,25 +3671,99 @@ public:
     }
 };  // class MetaInfo
 
-#if 0  // TODO?
-/// Specialize getting meta-value of runs range with "default" one; the point
-/// is to apply default values to the bounds that aren't set
-template<typename ValidityKeyT> inline ValidityRange<ValidityKeyT>
-MetaInfo::get< ValidityRange<ValidityKeyT> >(
-                  const std::string & name
-                , const ValidityRange<ValidityKeyT> & default_
-                , size_t lineNo  //=std::numeric_limits<size_t>::max()
-                ) const {
-    const auto vs = this->operator[](name);
-    std::map<size_t, std::string>::const_reverse_iterator
-                it(vs.upper_bound(lineNo));
-    if( it == vs.rend() ) {
-        return default_;
-    }
-    auto rr = aux::lexical_cast<ValidityRange<ValidityKeyT> >(it->second);
-    // If left or right limit of the range is left open, apply default
-    // substitution
-    if( ! ::sdc::is_set(rr.from) ) rr.from = default_.from;
+///\brief Provides metadata of the data rows read from shared snapshots
+///
+/// Rows of cached or compiled blocks refer to shared (immutable) metadata
+/// snapshots. This helper keeps own copy of the snapshot in effect, made
+/// only when the snapshot changes, with row line number set (`@lineNo`).
+/// Snapshots are thus never modified by the readers (value cache
+/// included), so they may be shared between concurrent readers.
+///
+///\ingroup indexing
+class RowMetaInfo {
+private:
+    const MetaInfo * _src;
+    MetaInfo _md;
+public:
+    RowMetaInfo() : _src(nullptr) {}
+    RowMetaInfo(const RowMetaInfo &) = delete;
+    RowMetaInfo & operator=(const RowMetaInfo &) = delete;
+
+    /// Returns metadata of the row; snapshot must outlive this instance
+    const MetaInfo & at( const MetaInfo & snapshot, size_t lineNo ) {
+        if( &snapshot != _src ) {
+            _md = snapshot;
+            _src = &snapshot;
+        }
+        _md.set_row_line(lineNo);
+        return _md;
+    }
+    /// Returns metadata of the last row
+    const MetaInfo & get() const { return _md; }
+};
+
+///\brief Primitives of binary (de)serialization used by persistent caches
+///
+/// Integers are written in native byte order, strings are length-prefixed.
+/// Reading routines set stream's fail bit on malformed input.
+///
+///\ingroup utils
+struct BinIO {
+    static void write( std::ostream & os, uint64_t v )
+        { os.write(reinterpret_cast<const char *>(&v), sizeof(v)); }
+    static void write( std::ostream & os, const std::string & str )
+        { write(os, str.size()); os.write(str.data(), str.size()); }
+    static void write( std::ostream & os, const MetaInfo & md ) {
+        write(os, md.size());
+        for( const auto & entry : md ) {
+            write(os, entry.first);
+            write(os, entry.second.first);
+            write(os, entry.second.second);
+        }
+    }
+    static uint64_t read_u64( std::istream & is ) {
+        uint64_t v = 0;
+        is.read(reinterpret_cast<char *>(&v), sizeof(v));
+        return v;
+    }
+    static std::string read_str( std::istream & is ) {
+        const uint64_t n = read_u64(is);
+        if( !is || n > (1ULL << 32) ) {
+            is.setstate(std::ios::failbit);
+            return "";
+        }
+        std::string str(n, '\0');
+        is.read(&str[0], n);
+        return str;
+    }
+    static void read_md( std::istream & is, MetaInfo & md ) {
+        for( uint64_t n = read_u64(is); is && n; --n ) {
+            const std::string name = read_str(is);
+            const uint64_t lineNo = read_u64(is);
+            md.set(name, read_str(is), lineNo);
+        }
+    }
+};
+
+#if 0  // TODO?
+/// Specialize getting meta-value of runs range with "default" one; the point
+/// is to apply default values to the bounds that aren't set
+template<typename ValidityKeyT> inline ValidityRange<ValidityKeyT>
+MetaInfo::get< ValidityRange<ValidityKeyT> >(
+                  const std::string & name
+                , const ValidityRange<ValidityKeyT> & default_
+                , size_t lineNo  //=std::numeric_limits<size_t>::max()
+                ) const {
+    const auto vs = this->operator[](name);
+    std::map<size_t, std::string>::const_reverse_iterator
+                it(vs.upper_bound(lineNo));
+    if( it == vs.rend() ) {
+        return default_;
+    }
+    auto rr = aux::lexical_cast<ValidityRange<ValidityKeyT> >(it->second);
+    // If left or right limit of the range is left open, apply default
+    // substitution
+    if( ! ::sdc::is_set(rr.from) ) rr.from = default_.from;
     if( ! ::sdc::is_set(rr.to)   ) rr.to   = default_.to;
     return rr;
 }
@@ -1979,7 +3804,7 @@ public:
     /// A data type of the document kept
     struct DocumentEntry {
         /// Identifier to the document
-        std::string docID;
+        aux::Atom docID;
         /// End of validity period for calibration; considered only if set
         KeyT validTo;
         /// Any other user data associated with this document entry
@@ -2002,7 +3827,137 @@ protected:
                          , typename ValidityTraits<KeyT>::Less
                          > DocsIndex;
     /// By-type dictionary of indexes
-    std::unordered_map<std::string, DocsIndex> _types;
+    std::unordered_map<aux::Atom, DocsIndex, aux::Atom::Hash> _types;
+    /// By-type dictionaries of entries' validity ends (to validity starts),
+    /// for entries having validity end
+    std::unordered_map< aux::Atom
+                      , std::multimap<KeyT, KeyT, typename ValidityTraits<KeyT>::Less>
+                      , aux::Atom::Hash
+                      > _expirations;
+
+    /**\brief Index of entries covering certain key
+     *
+     * Keeps entries of the type in order of `DocsIndex` with implicit binary
+     * tree over them, each node holding the latest validity end within its
+     * subtree (unset, if any entry there has no validity end). Lookup of the
+     * entries valid for a key skips subtrees ending before the key, so its
+     * cost depends on the number of entries found rather than on the number
+     * of all the entries of the type.
+     * */
+    struct CoverIndex {
+        /// Entries of the type, in order of by-run index
+        std::vector<const typename DocsIndex::value_type *> entries;
+        /// Latest validity ends of the subtrees; root node is #1
+        std::vector<KeyT> maxEnd;
+
+        explicit CoverIndex( const DocsIndex & index ) {
+            entries.reserve(index.size());
+            for( const auto & e : index ) entries.push_back(&e);
+            if( entries.empty() ) return;
+            maxEnd.resize(4*entries.size());
+            _build(1, 0, entries.size());
+        }
+
+        /// Appends entries valid for the key to updates list, in order
+        void collect( KeyT key, Updates & us ) const {
+            const typename ValidityTraits<KeyT>::Less less;
+            // number of entries starting before or at the key
+            const size_t nStarted = std::upper_bound( entries.begin(), entries.end(), key
+                    , [&less](KeyT k, const typename DocsIndex::value_type * e) {
+                        return less(k, e->first);
+                    } ) - entries.begin();
+            if( nStarted ) _collect(1, 0, entries.size(), nStarted, key, us);
+        }
+    private:
+        static bool _covers( KeyT end, KeyT key ) {
+            return (!ValidityTraits<KeyT>::is_set(end))
+                || typename ValidityTraits<KeyT>::Less()(key, end);
+        }
+
+        void _build( size_t node, size_t lo, size_t hi ) {
+            if( hi - lo == 1 ) {
+                maxEnd[node] = entries[lo]->second.validTo;
+                return;
+            }
+            const size_t mid = (lo + hi)/2;
+            _build(2*node, lo, mid);
+            _build(2*node + 1, mid, hi);
+            const KeyT & l = maxEnd[2*node]
+                     , & r = maxEnd[2*node + 1]
+                     ;
+            if( !(ValidityTraits<KeyT>::is_set(l) && ValidityTraits<KeyT>::is_set(r)) )
+                maxEnd[node] = ValidityTraits<KeyT>::unset;
+            else
+                maxEnd[node] = typename ValidityTraits<KeyT>::Less()(l, r) ? r : l;
+        }
+
+        void _collect( size_t node, size_t lo, size_t hi, size_t nStarted
+                     , KeyT key, Updates & us ) const {
+            if( lo >= nStarted || !_covers(maxEnd[node], key) ) return;
+            if( hi - lo == 1 ) {
+                us.push_back(typename Updates::value_type( entries[lo]->first
+                                                         , &(entries[lo]->second)));
+                return;
+            }
+            const size_t mid = (lo + hi)/2;
+            _collect(2*node, lo, mid, nStarted, key, us);
+            _collect(2*node + 1, mid, hi, nStarted, key, us);
+        }
+    };
+
+    /// By-type cover indexes built on demand, dropped on modification
+    ///
+    /// Refers to the entries of the owning instance, so copies start empty.
+    /// Building is guarded, so const queries may run concurrently.
+    class CoverIndexes {
+    private:
+        std::unordered_map<aux::Atom, CoverIndex, aux::Atom::Hash> _indexes;
+        std::shared_mutex _mtx;
+    public:
+        CoverIndexes() = default;
+        CoverIndexes( const CoverIndexes & ) {}
+        CoverIndexes( CoverIndexes && o ) : _indexes(std::move(o._indexes)) {}
+        CoverIndexes & operator=( const CoverIndexes & ) {
+            _indexes.clear();
+            return *this;
+        }
+        CoverIndexes & operator=( CoverIndexes && o ) {
+            _indexes = std::move(o._indexes);
+            return *this;
+        }
+
+        /// Returns index of the type, building it if need
+        ///
+        /// Returned reference remains valid until the type is dropped.
+        const CoverIndex & get( const aux::Atom & type, const DocsIndex & index ) {
+            {
+                std::shared_lock<std::shared_mutex> lock(_mtx);
+                auto it = _indexes.find(type);
+                if( _indexes.end() != it ) return it->second;
+            }
+            std::unique_lock<std::shared_mutex> lock(_mtx);
+            // might be built by other thread meanwhile
+            auto it = _indexes.find(type);
+            if( _indexes.end() == it )
+                it = _indexes.emplace(type, CoverIndex(index)).first;
+            return it->second;
+        }
+        /// Drops index of the type; called on modification only
+        void drop( const aux::Atom & type ) { _indexes.erase(type); }
+    };
+    mutable CoverIndexes _covers;
+
+    /// Returns atom of the type name for queries by string
+    ///
+    /// Type names that were never interned are not indexed, so either
+    /// `UnknownDataType` is thrown, or empty atom is returned (if
+    /// `noTypeIsOk`), which is never used as type name either.
+    static aux::Atom _type_of( std::string_view typeName, bool noTypeIsOk ) {
+        const auto atom = aux::Atom::find(typeName);
+        if( atom ) return *atom;
+        if( noTypeIsOk ) return aux::Atom();
+        throw errors::UnknownDataType(std::string(typeName));
+    }
 public:
     ///\brief Adds document entry of certain type with runs range
     ///
@@ -2013,17 +3968,57 @@ public:
     /// obtain calibration data type, runs range and any data for `auxInfo`
     /// instance associated with particular doc.
     typename DocsIndex::iterator
-    add_entry( const std::string & docID
-             , const std::string & dataType
+    add_entry( const aux::Atom & docID
+             , const aux::Atom & dataType
              , KeyT from, KeyT to
              , const AuxInfoT & auxInfo
              ) {
         auto ir1 = _types.emplace(dataType, DocsIndex());
         auto ir2 = ir1.first->second.emplace( from
                         , DocumentEntry{docID, to, auxInfo} );
+        if( ValidityTraits<KeyT>::is_set(to) )
+            _expirations[dataType].emplace(to, from);
+        _covers.drop(dataType);
         return ir2;
     }
 
+    ///\brief Removes all entries of the document
+    ///
+    /// Types left without entries are removed as well. Returns number of
+    /// removed entries.
+    size_t remove_document( const aux::Atom & docID ) {
+        size_t nRemoved = 0;
+        for( auto typeIt = _types.begin(); typeIt != _types.end(); ) {
+            for( auto it = typeIt->second.begin(); it != typeIt->second.end(); ) {
+                if( it->second.docID != docID ) { ++it; continue; }
+                if( ValidityTraits<KeyT>::is_set(it->second.validTo) ) {
+                    auto & exps = _expirations[typeIt->first];
+                    auto er = exps.equal_range(it->second.validTo);
+                    for( auto eIt = er.first; eIt != er.second; ++eIt ) {
+                        if( !(eIt->second == it->first) ) continue;
+                        exps.erase(eIt);
+                        break;
+                    }
+                    if( exps.empty() ) _expirations.erase(typeIt->first);
+                }
+                it = typeIt->second.erase(it);
+                _covers.drop(typeIt->first);
+                ++nRemoved;
+            }
+            if( typeIt->second.empty() )
+                typeIt = _types.erase(typeIt);
+            else
+                ++typeIt;
+        }
+        return nRemoved;
+    }
+    /// Same as `remove_document()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, size_t>
+    remove_document( const S & docID ) {
+        const auto atom = aux::Atom::find(docID);
+        return atom ? remove_document(*atom) : 0;
+    }
+
     /**\brief Returns list of "still valid" documents to be applied, in order
      *
      * This querying method returns documents list to be processed in order to
@@ -2042,9 +4037,14 @@ public:
      * returns an empty list if no calibration data type can be retrieved.
      * (yet, if type exists, but no data present no exception thrown anyway).
      *
+     * Entries are looked up with the cover index of the type (built on first
+     * query after modification, in linear time), taking logarithmic time
+     * per returned entry. Concurrent queries are safe, as long as the index
+     * is not modified meanwhile.
+     *
      * \throws `sdc::errors::UnknownDataType` if not such data type defined.
      * */
-    Updates updates( const std::string & typeName
+    Updates updates( const aux::Atom & typeName
                    , KeyT key
                    , bool noTypeIsOk=false ) const {
         // find by-types index
@@ -2054,23 +4054,14 @@ public:
             throw errors::UnknownDataType(typeName);
         }
         Updates us;
-        // locate latest item for certain key
-        auto upb = typeIt->second.upper_bound(key);
-        // iterate till the item, omitting entries that are not currently
-        // valid, put valid entries into updates list
-        for( auto it = typeIt->second.begin()
-           ; it != upb
-           ; ++it ) {
-            if( ValidityTraits<KeyT>::is_set(it->second.validTo)
-             && ( typename ValidityTraits<KeyT>::Less()(it->second.validTo, key)
-               || it->second.validTo == key ) ) {
-                continue;  // stale
-            }
-            us.push_back(typename Updates::value_type( it->first
-                                                     , &(it->second)));
-        }
+        _covers.get(typeName, typeIt->second).collect(key, us);
         return us;
     }
+    /// Same as `updates()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, Updates>
+    updates( const S & typeName, KeyT key, bool noTypeIsOk=false ) const {
+        return updates(_type_of(typeName, noTypeIsOk), key, noTypeIsOk);
+    }
 
     /**\brief Finds updates between two keys
      *
@@ -2079,7 +4070,7 @@ public:
      *
      * \todo UT
      * */
-    Updates updates( const std::string & typeName
+    Updates updates( const aux::Atom & typeName
                    , KeyT oldKey, KeyT newKey
                    , bool noTypeIsOk=false
                    , bool keepStale=false
@@ -2111,6 +4102,39 @@ public:
         }
         return us;
     }
+    /// Same as `updates()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, Updates>
+    updates( const S & typeName, KeyT oldKey, KeyT newKey
+           , bool noTypeIsOk=false, bool keepStale=false ) const {
+        return updates( _type_of(typeName, noTypeIsOk), oldKey, newKey
+                      , noTypeIsOk, keepStale );
+    }
+
+    /**\brief Returns whether any entry valid for one key expires by another
+     *
+     * Checks whether there are entries of certain type valid for `oldKey`
+     * and not valid for `newKey` (`oldKey` < `newKey`). If there are none,
+     * the updates for `newKey` are the ones for `oldKey` followed by
+     * `updates(typeName, oldKey, newKey)`. Takes logarithmic time.
+     * */
+    bool expires( const aux::Atom & typeName, KeyT oldKey, KeyT newKey ) const {
+        auto typeIt = _expirations.find(typeName);
+        if( _expirations.end() == typeIt ) return false;
+        const typename ValidityTraits<KeyT>::Less less;
+        // validity ends within (oldKey, newKey]
+        for( auto it = typeIt->second.upper_bound(oldKey)
+           ; it != typeIt->second.end() && !less(newKey, it->first)
+           ; ++it ) {
+            if( !less(oldKey, it->second) ) return true;  // was valid for old
+        }
+        return false;
+    }
+    /// Same as `expires()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, bool>
+    expires( const S & typeName, KeyT oldKey, KeyT newKey ) const {
+        const auto atom = aux::Atom::find(typeName);
+        return atom && expires(*atom, oldKey, newKey);
+    }
 
     /**\brief Returns latest document entry for certain run number and type
      *
@@ -2124,7 +4148,7 @@ public:
      * \todo Optimize me. Lookup loop seems to be suboptimal.
      */
     typename Updates::value_type
-        latest( const std::string & typeName
+        latest( const aux::Atom & typeName
               , KeyT key
               ) const {
         // find by-types index
@@ -2151,9 +4175,14 @@ public:
             if( it == index.begin() ) throw errors::NoCalibrationData(typeName, key);
         }
     }
+    /// Same as `latest()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, typename Updates::value_type>
+    latest( const S & typeName, KeyT key ) const {
+        return latest(_type_of(typeName, false), key);
+    }
 
     /// Returns immutable index entries
-    const std::unordered_map<std::string, DocsIndex> &
+    const std::unordered_map<aux::Atom, DocsIndex, aux::Atom::Hash> &
         entries() const {return _types;}
 
     friend class Documents<KeyT>;
@@ -2162,6 +4191,286 @@ public:
 /// Data traits defining the to-structure conversion procedure
 template<typename T> struct CalibDataTraits;
 
+/**\brief Context of the data row being parsed
+ *
+ * Lightweight object passed to `CalibDataTraits<T>::parse_line()` overload
+ * of the form
+ *
+ *      static T parse_line(const std::string & line, const RowContext & ctx);
+ *
+ * Carries line number and document ID of the row with metadata of the data
+ * block, so that no per-row metadata has to be maintained in
+ * `aux::MetaInfo` (`@lineNo` entry is still provided by `ctx.md`, see
+ * `aux::MetaInfo::set_row_line()`). Traits providing only the "legacy"
+ * `parse_line(line, lineNo, md, docID, loadLogPtr)` are still supported
+ * (see `parse_row()`).
+ *
+ * \ingroup type-traits
+ * */
+struct RowContext {
+    /// Line number of the row within the document
+    size_t lineNo;
+    /// Document ID of the row
+    const std::string & docID;
+    /// Metadata in effect for the row
+    const aux::MetaInfo & md;
+    /// Loading log (may be null)
+    aux::LoadLog * loadLogPtr;
+    /// Arena for parsing temporaries of the current loading operation (null
+    /// if row is parsed outside of loading operation), see `aux::Arena`
+    aux::Arena * arena = aux::Arena::current();
+};
+
+namespace aux {
+/// Detects whether calibration data traits provide `parse_line()` overload
+/// accepting `RowContext`
+template<typename T, typename=void>
+struct HasRowContextParser : public std::false_type {};
+
+template<typename T>
+struct HasRowContextParser< T, std::void_t<decltype(
+            CalibDataTraits<T>::parse_line( std::declval<const std::string &>()
+                                          , std::declval<const RowContext &>() )
+        )> > : public std::true_type {};
+}  // namespace ::sdc::aux
+
+/**\brief Parses data row with calibration data traits
+ *
+ * Forwards call to `CalibDataTraits<T>::parse_line()` accepting `RowContext`,
+ * if defined, or to one accepting line number, metadata, document ID and
+ * loading log otherwise.
+ *
+ * \ingroup type-traits
+ * */
+template<typename T> T
+parse_row( const std::string & line, const RowContext & ctx ) {
+    if constexpr (aux::HasRowContextParser<T>::value) {
+        return CalibDataTraits<T>::parse_line(line, ctx);
+    } else {
+        return CalibDataTraits<T>::parse_line( line, ctx.lineNo, ctx.md
+                                             , ctx.docID, ctx.loadLogPtr );
+    }
+}
+
+namespace aux {
+
+/**\brief Typed column of the data row
+ *
+ * Binds column name (as it appears in `columns=` metadata) to the field of
+ * the item type. Created with `column()`; columns without default value are
+ * required. See `ColumnsSchema`.
+ *
+ * \ingroup type-traits
+ * */
+template<typename T, typename FieldT>
+struct Column {
+    /// Column name
+    const char * name;
+    /// Field of the item to set
+    FieldT T::* field;
+    /// Whether column must be defined in `columns=` metadata
+    bool required;
+    /// Value to be set if column is not defined
+    FieldT default_;
+};
+
+/// Creates required column binding
+template<typename T, typename FieldT> Column<T, FieldT>
+column( const char * name, FieldT T::* field ) {
+    return Column<T, FieldT>{name, field, true, FieldT()};
+}
+
+/// Creates optional column binding with default value
+template<typename T, typename FieldT> Column<T, FieldT>
+column( const char * name, FieldT T::* field
+      , const typename std::decay<FieldT>::type & default_ ) {
+    return Column<T, FieldT>{name, field, false, default_};
+}
+
+/**\brief Typed description of the data row columns
+ *
+ * Declares columns of calibration data type with the fields they are
+ * converted into once, within the `CalibDataTraits`:
+ *
+ *     static inline const auto schema = sdc::aux::columns_schema(
+ *                  sdc::aux::column("channel", &CaloCalib::channel)
+ *                , sdc::aux::column("peakpos", &CaloCalib::peakpos, 0.)
+ *                );
+ *
+ * and fills the item from the data row in `parse_line()`:
+ *
+ *     static CaloCalib parse_line( const std::string & line
+ *                                , const sdc::RowContext & ctx ) {
+ *         CaloCalib item;
+ *         schema.fill(item, line, ctx);
+ *         return item;
+ *     }
+ *
+ * Comparing to `ColumnsOrder::interpret()` no per-row maps or strings are
+ * created: `columns=` metadata value is resolved to the column indexes once
+ * (resolutions are cached per thread, by schema instance and the metadata
+ * value), line is split into views and cells are converted directly into
+ * fields. As with `interpret()`, row must provide all the columns listed
+ * in `columns=`; columns that are not declared by schema are not converted.
+ *
+ * \ingroup type-traits
+ * */
+template<typename T, typename ... ColumnTs>
+class ColumnsSchema {
+public:
+    /// Number of declared columns
+    static constexpr size_t nColumns = sizeof...(ColumnTs);
+private:
+    /// Columns bindings
+    std::tuple<ColumnTs...> _columns;
+    /// Unique ID of schema instance, identifies cached resolutions
+    ///
+    /// Address can not be used for that as another schema may be created
+    /// at the same one.
+    size_t _id;
+    /// Columns order resolved for certain `columns=` value
+    struct Resolved {
+        /// ID of schema instance the resolution belongs to
+        size_t schemaID;
+        /// Value of `columns=` metadata
+        std::string columns;
+        /// Token index for each of the declared columns, -1 if not defined
+        std::array<int, nColumns> indexes;
+        /// Largest token index in `columns=`, -1 if no columns
+        int maxIndex;
+        /// Name of the column with largest index
+        std::string maxIndexName;
+    };
+
+    /// Returns new unique schema instance ID
+    static size_t _new_id() {
+        static std::atomic<size_t> lastID(0);
+        return ++lastID;
+    }
+    /// Maximum number of resolutions kept per thread
+    static constexpr size_t nResolvedMax = 16;
+
+    /// Returns column index resolution for the metadata value
+    const Resolved & _resolve( const std::string & columns ) const {
+        static thread_local std::vector<Resolved> resolved;
+        for( size_t i = 0; i < resolved.size(); ++i ) {
+            if( resolved[i].schemaID != _id || resolved[i].columns != columns ) continue;
+            if( i ) std::swap(resolved[i], resolved[0]);  // most recent first
+            return resolved[0];
+        }
+        Resolved r{_id, columns, {}, -1, ""};
+        const ColumnsOrder order = lexical_cast<ColumnsOrder>(columns);
+        _resolve_indexes(order, r, std::index_sequence_for<ColumnTs...>());
+        for( const auto & c : order ) {
+            if( c.second <= r.maxIndex ) continue;
+            r.maxIndex = c.second;
+            r.maxIndexName = c.first;
+        }
+        if( resolved.size() == nResolvedMax ) resolved.pop_back();
+        resolved.insert(resolved.begin(), std::move(r));
+        return resolved[0];
+    }
+
+    template<size_t ... Is> void
+    _resolve_indexes( const ColumnsOrder & order, Resolved & r
+                    , std::index_sequence<Is...> ) const {
+        ( _resolve_index(order, std::get<Is>(_columns), r.indexes[Is]), ... );
+    }
+
+    template<typename ColumnT> static void
+    _resolve_index( const ColumnsOrder & order, const ColumnT & col, int & idx ) {
+        auto it = order.find(col.name);
+        idx = order.end() == it ? -1 : it->second;
+    }
+
+    /// Converts cell into the field
+    template<typename FieldT> static void
+    _convert( FieldT & dest, std::string_view cell ) {
+        if constexpr (std::is_same<FieldT, std::string>::value) {
+            dest.assign(cell.data(), cell.size());
+        } else if constexpr (std::is_arithmetic<FieldT>::value
+                         && !std::is_same<FieldT, bool>::value) {
+            dest = numeric_cast<FieldT>(cell);
+        } else {
+            static thread_local std::string buf;  // re-used buffer
+            buf.assign(cell.data(), cell.size());
+            dest = lexical_cast<FieldT>(buf);
+        }
+    }
+
+    template<typename ColumnT> static void
+    _fill_column( T & dest, const ColumnT & col, int idx
+                , const Tokens & toks
+                , LoadLog * loadLogPtr ) {
+        if( idx < 0 ) {
+            if( col.required ) throw errors::NoColumnDefinedForTable(col.name);
+            dest.*(col.field) = col.default_;
+            return;
+        }
+        _convert(dest.*(col.field), toks[idx]);
+        if( loadLogPtr ) loadLogPtr->add_entry(col.name, std::string(toks[idx]));
+    }
+
+    template<size_t ... Is> void
+    _fill( T & dest, const Resolved & r
+         , const Tokens & toks
+         , LoadLog * loadLogPtr
+         , std::index_sequence<Is...> ) const {
+        ( _fill_column(dest, std::get<Is>(_columns), r.indexes[Is], toks, loadLogPtr), ... );
+    }
+public:
+    ColumnsSchema( const ColumnTs & ... columns ) : _columns(columns...), _id(_new_id()) {}
+    ColumnsSchema( const ColumnsSchema & o ) : _columns(o._columns), _id(_new_id()) {}
+    ColumnsSchema & operator=( const ColumnsSchema & o ) {
+        _columns = o._columns;
+        _id = _new_id();
+        return *this;
+    }
+
+    /**\brief Sets declared fields of the item from the data row
+     *
+     * Uses `columns` metadata entry in effect for the row.
+     *
+     * \throws `errors::NoColumnDefinedForTable` if required column is not
+     *      defined by metadata
+     * \throws `errors::ParserError` if row has less tokens than columns
+     *      listed in `columns=` metadata
+     * */
+    void fill( T & dest, std::string_view line, const RowContext & ctx ) const {
+        static const aux::Atom columnsKey("columns");
+        const std::string * columns = ctx.md.find_strexpr(columnsKey);
+        if( !columns ) throw errors::NoMetadataEntryInFile("columns");
+        const Resolved & r = _resolve(*columns);
+        const Tokens toks = tokenize_view(line);
+        if( r.maxIndex >= 0 && toks.size() <= (size_t) r.maxIndex ) {
+            char errBuf[256];
+            snprintf(errBuf, sizeof(errBuf)
+                    , "Columns number mismatch; no column #%d expected"
+                    " for \"%s\" in current line (has only %zu columns)"
+                    , r.maxIndex + 1, r.maxIndexName.c_str(), toks.size()
+                    );
+            throw errors::ParserError(errBuf);
+        }
+        _fill(dest, r, toks, ctx.loadLogPtr, std::index_sequence_for<ColumnTs...>());
+    }
+
+    /// Returns default-constructed item with declared fields set from row
+    T parse( std::string_view line, const RowContext & ctx ) const {
+        T item;
+        fill(item, line, ctx);
+        return item;
+    }
+};
+
+/// Creates columns schema from column bindings (see `ColumnsSchema`)
+template<typename T, typename FieldT, typename ... ColumnTs>
+ColumnsSchema<T, Column<T, FieldT>, ColumnTs...>
+columns_schema( const Column<T, FieldT> & first, const ColumnTs & ... other ) {
+    return ColumnsSchema<T, Column<T, FieldT>, ColumnTs...>(first, other...);
+}
+
+}  // namespace ::sdc::aux
+
 /**\brief Representation of calibration data documents collection
  *
  * This stateful object maintains collecteion of loaders with validity index
@@ -2186,6 +4495,23 @@ public:
         /// Line number of data block start (or other internal markup marker
         /// encoded)
         IntradocMarkup_t blockBgn;
+        /// Byte offset of the data block start within the document; valid
+        /// only if `mdSnapshot` is set
+        size_t blockOffset;
+        ///\brief Metadata in effect at the block start, if captured by loader
+        ///
+        /// Immutable snapshot taken at pre-parsing; shared between
+        /// consecutive blocks if metadata did not change in between. Keeps
+        /// only the latest value of each entry defined before the block
+        /// (ones superseded are of no use for block lines). Loaders that do
+        /// not support seeking leave it null.
+        std::shared_ptr<const aux::MetaInfo> mdSnapshot;
+        ///\brief Decompressor restart point preceding the block start
+        ///
+        /// Set by loaders for compressed documents, if available, so that
+        /// block reading does not require decompression of the entire
+        /// document. Valid only if `mdSnapshot` is set.
+        std::shared_ptr<const aux::RestartPoint> restartPoint;
     };
 
     /**\brief A document reader of certain format
@@ -2236,6 +4562,18 @@ public:
             }
         } defaults;
 
+        ///\brief Serializes reading operations of the loader
+        ///
+        /// Reading relies on loader's state (`defaults` are set to ones of
+        /// the document being read), so concurrent loading operations of
+        /// `Documents` lock it while loader is in use. Recursive, as
+        /// loading operations may nest. Not copied with the loader.
+        struct ReadMutex : public std::recursive_mutex {
+            ReadMutex() {}
+            ReadMutex( const ReadMutex & ) : std::recursive_mutex() {}
+            ReadMutex & operator=( const ReadMutex & ) { return *this; }
+        } readMutex;
+
         iLoader() : defaults {"", { KeyT(ValidityTraits<KeyT>::unset)
                                   , KeyT(ValidityTraits<KeyT>::unset)
                                   }, aux::MetaInfo()
@@ -2281,6 +4619,138 @@ public:
                               , IntradocMarkup_t acceptFrom
                               , ReaderCallback cllb
                               ) = 0;
+
+        /**\brief Retrieves the data of certain block
+         *
+         * Same as `read_data()`, but is given with the full block
+         * description as it was returned by `get_doc_struct()`, so loaders
+         * that recorded positional markup may seek directly to the block
+         * instead of scanning the document. Default implementation forwards
+         * call to `read_data()` with block's start marker.
+         */
+        virtual void read_block( const std::string & docID
+                               , KeyT k
+                               , const std::string & forType
+                               , const DataBlock & block
+                               , ReaderCallback cllb
+                               ) {
+            read_data(docID, k, forType, block.blockBgn, cllb);
+        }
+
+        /// Single block reading request used by `read_blocks()`
+        struct BlockRead {
+            /// Data type of the block
+            std::string forType;
+            /// Block description
+            const DataBlock * block;
+            /// Loader defaults to be set for the block reading (optional)
+            const Defaults * defaults;
+            /// Callback receiving block's data
+            ReaderCallback cllb;
+        };
+
+        /**\brief Retrieves data of multiple blocks of the document
+         *
+         * Used to read blocks of different types within a single pass over
+         * the document. Implementation is free to read the blocks in any order
+         * (e.g. in order of their appearance in the document), but rows of
+         * each block must be forwarded to the block's callback. If
+         * `BlockRead::defaults` is set, loader's defaults must be set to
+         * it prior to reading the block; caller is responsible to restore
+         * the defaults afterwards.
+         *
+         * Default implementation sequentially calls `read_block()`.
+         */
+        virtual void read_blocks( const std::string & docID
+                                , KeyT k
+                                , const std::vector<BlockRead> & reads
+                                ) {
+            for( const auto & r : reads ) {
+                if( r.defaults ) defaults = *r.defaults;
+                read_block(docID, k, r.forType, *r.block, r.cllb);
+            }
+        }
+
+        /**\brief Whether block content read by this loader may be cached
+         *
+         * Shall return `true` only if rows forwarded by `read_block()` do
+         * depend solely on the block (not on the validity key or on other
+         * blocks of the document), so they may be re-used for other keys.
+         */
+        virtual bool cacheable_blocks() const { return false; }
+
+        /**\brief Hints loader that blocks of the document will be read soon
+         *
+         * Called by `Documents` loading routines for all the documents
+         * involved in the query before reading starts, so implementation
+         * may initiate asynchronous reading (e.g. with `posix_fadvise()`) to
+         * overlap I/O with parsing. Must not block on I/O and must not
+         * throw on inaccessible documents (errors shall be reported by the
+         * reading routines). Default implementation does nothing.
+         */
+        virtual void prefetch( const std::string & docID
+                             , const std::vector<const DataBlock *> & blocks
+                             ) { (void) docID; (void) blocks; }
+
+        /**\brief Describes settings affecting the documents structure
+         *
+         * Used to validate persistent caches of `get_doc_struct()` results
+         * (see `Documents::StructureCache`): structure may be re-used only if
+         * fingerprint is the same. Default implementation describes loader's
+         * type and defaults; loaders having other settings (like grammar)
+         * shall append them.
+         */
+        virtual std::string structure_fingerprint() const {
+            std::ostringstream oss;
+            oss << typeid(*this).name() << ":";
+            defaults.to_json(oss);
+            return oss.str();
+        }
+
+        /**\brief Pull-based reader of the block rows
+         *
+         * Alternative to callback-based `read_block()`, yielding rows one
+         * by one, on demand. Metadata, line number and expression returned
+         * by getters are valid till the next call of `next()`.
+         */
+        class iRowCursor {
+        public:
+            virtual ~iRowCursor() {}
+            /// Advances to the next row; returns `false` if no more rows
+            virtual bool next() = 0;
+            /// Metadata in effect for current row
+            virtual const aux::MetaInfo & metainfo() const = 0;
+            /// Line number of current row
+            virtual size_t line_number() const = 0;
+            /// Content of current row
+            virtual const std::string & expression() const = 0;
+        };
+
+        /**\brief Returns cursor over the block rows
+         *
+         * Loader's defaults must be set for the block before the call; cursor
+         * shall not depend on them afterwards.
+         *
+         * Default implementation reads the block with `read_block()`,
+         * keeping rows in memory. Loaders capable to parse the data
+         * incrementally should override it.
+         */
+        virtual std::unique_ptr<iRowCursor>
+        open_block( const std::string & docID
+                  , KeyT k
+                  , const std::string & forType
+                  , const DataBlock & block
+                  ) {
+            auto entry = std::make_shared<typename BlockCache::Entry>();
+            read_block( docID, k, forType, block
+                      , [&]( const aux::MetaInfo & meta
+                           , size_t lineNo
+                           , const std::string & expression ) {
+                            entry->add(meta, lineNo, expression);
+                            return true;
+                        } );
+            return std::unique_ptr<iRowCursor>(new CachedBlockCursor(entry));
+        }
     };
 
     /// Colllection of loaders, capable to obtain structures
@@ -2295,8 +4765,8 @@ public:
         typename iLoader::Defaults docDefaults;
         /// Pointer to loader in use
         std::shared_ptr<iLoader> loader;
-        /// Last block start marker
-        IntradocMarkup_t dataBlockBgn;
+        /// Block description (start marker, positional markup)
+        DataBlock dataBlock;
         /// Prints document loading state as JSON
         void to_json(std::ostream & os) const {
             os << "{"
@@ -2308,62 +4778,962 @@ public:
     /// Index of documents with polymorphic aux info
     ValidityIndex<KeyT, DocumentLoadingState> validityIndex;
 
-    typedef typename ValidityIndex<KeyT, DocumentLoadingState>::Updates::value_type Update;
-public:
-    // TODO: doc
-    template<typename T> void
-    load_update_into( const typename ValidityIndex< KeyT
-                                                  , DocumentLoadingState
-                                                  >::Updates::value_type upd
-                    , typename CalibDataTraits<T>::template Collection<> & dest
-                    , KeyT forKey
-                    , aux::LoadLog * loadLogPtr=nullptr
-                    ) const {
-        // doc entry to read (has docID, valid-to, auxinfo which is of this
-        // class' DocumentLoadingState -- defaults+loader )
-        const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry *
-            docEntryPtr = upd.second;
-        // particular loader ptr
-        iLoader *
-            loaderPtr = docEntryPtr->auxInfo.loader.get();
-        // copy of loader's defaults to be restored
-        const typename iLoader::Defaults dftsBck = loaderPtr->defaults;
-        // set metadata to one saved on pre-parsing
-        loaderPtr->defaults = docEntryPtr->auxInfo.docDefaults;
-        // Here static and dynamic polymorphism join.
-        // We use C++ lambda function to make runtime-polymorphic handler
-        // to read the data into statically-derived data structure.
-        try {
-            loaderPtr->read_data( docEntryPtr->docID
-                  , forKey
-                  , CalibDataTraits<T>::typeName
-                  , docEntryPtr->auxInfo.dataBlockBgn
-                  , [&]( const typename aux::MetaInfo & meta
-                       , size_t lineNo
-                       , const std::string & expression ) {
-                            if(loadLogPtr) loadLogPtr->set_source(docEntryPtr->docID, lineNo);
-                            try {
-                                CalibDataTraits<T>::collect( dest
-                                        , CalibDataTraits<T>::parse_line(
-                                                expression
-                                              , lineNo
-                                              , meta
-                                              , docEntryPtr->docID
-                                              , loadLogPtr
-                                              )
-                                        , meta
-                                        , lineNo
-                                        );
-                            } catch( errors::RuntimeError & e ) {
-                                throw errors::NestedError<errors::ParserError>( e
-                                    , "while parsing or collecting data block"
-                                    , expression
-                                    , docEntryPtr->docID
-                                    , meta.get<size_t>("@lineNo"
-                                        , std::numeric_limits<size_t>::max()
-                                        , std::numeric_limits<size_t>::max()
-                                        ) );
-                            }
+    /**\brief Cache of pre-tokenized data blocks
+     *
+     * Keeps rows forwarded by loader for a data block (line number and
+     * stripped line) with snapshots of metadata in effect, so subsequent
+     * loads for other validity keys only run `CalibDataTraits<T>::parse_line()`
+     * and `collect()` for the block. Entries are keyed by document ID and
+     * block's start line and evicted in least-recently-used order once
+     * memory budget is exceeded.
+     *
+     * Only used with loaders permitting it (see `iLoader::cacheable_blocks()`).
+     *
+     * Cache is internally locked, so const loading operations of
+     * `Documents` may run concurrently. Replayed rows are given to
+     * `parse_line()` with per-load copies of metadata snapshots; reading of
+     * blocks not cached is serialized per loader (`iLoader::readMutex`).
+     */
+    class BlockCache {
+    public:
+        /// Cached data row
+        struct Row {
+            /// Line number of the row
+            size_t lineNo;
+            /// Row content as it was forwarded by loader
+            std::string expression;
+            /// Index of metadata snapshot in effect
+            size_t nMD;
+        };
+        /// Cached content of the block
+        struct Entry {
+            /// Metadata snapshots
+            std::vector< std::shared_ptr<const aux::MetaInfo> > mds;
+            /// Data rows of the block
+            std::vector<Row> rows;
+            /// Approximate memory consumption, bytes
+            size_t nBytes;
+
+            Entry() : nBytes(sizeof(Entry)) {}
+
+            /// Appends row, taking metadata snapshot if metadata changed
+            void add( const aux::MetaInfo & meta
+                    , size_t lineNo
+                    , const std::string & expression
+                    ) {
+                if( mds.empty() || _lastMDSize != meta.size() ) {
+                    auto md = std::make_shared<const aux::MetaInfo>(meta);
+                    for( const auto & p : *md ) {
+                        nBytes += p.first.size() + p.second.second.size()
+                                + 4*sizeof(void*);
+                    }
+                    mds.push_back(md);
+                    _lastMDSize = meta.size();
+                }
+                rows.push_back(Row{lineNo, expression, mds.size() - 1});
+                nBytes += sizeof(Row) + expression.size();
+            }
+
+            /// Forwards cached rows to the callback
+            ///
+            /// Snapshots are not modified: callback gets own copy of
+            /// snapshot in effect, with `@lineNo` of the row.
+            void replay( typename iLoader::ReaderCallback cllb ) const {
+                aux::RowMetaInfo md;
+                for( const auto & row : rows ) {
+                    if( !cllb(md.at(*mds[row.nMD], row.lineNo), row.lineNo, row.expression) ) break;
+                }
+            }
+        private:
+            size_t _lastMDSize;
+        };
+        /// Cache key: document ID and block start line
+        typedef std::pair<aux::Atom, IntradocMarkup_t> Key;
+    private:
+        typedef std::list< std::pair<Key, std::shared_ptr<const Entry>> > LRUList;
+        /// Memory budget, bytes
+        size_t _budget;
+        /// Current consumption, bytes
+        size_t _nBytes;
+        /// Hit and miss counters
+        mutable size_t _nHits, _nMisses;
+        /// Entries, most recently used first
+        LRUList _lru;
+        /// Index of entries
+        std::map<Key, typename LRUList::iterator> _index;
+        /// Guards all the above, as cache is used by const (concurrent)
+        /// loading operations
+        mutable std::mutex _mtx;
+
+        /// Removes entry, if cached; lock must be held
+        void _drop( const Key & key ) {
+            auto it = _index.find(key);
+            if( _index.end() == it ) return;
+            _nBytes -= it->second->second->nBytes;
+            _lru.erase(it->second);
+            _index.erase(it);
+        }
+    public:
+        BlockCache(size_t budgetBytes) : _budget(budgetBytes)
+                                       , _nBytes(0)
+                                       , _nHits(0)
+                                       , _nMisses(0)
+                                       {}
+        /// Returns cached entry or null pointer, counting hits and misses
+        std::shared_ptr<const Entry> get( const Key & key ) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            auto it = _index.find(key);
+            if( _index.end() == it ) {
+                ++_nMisses;
+                return nullptr;
+            }
+            ++_nHits;
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return it->second->second;
+        }
+        /// Puts entry into cache, evicting least recently used ones
+        ///
+        /// Entries exceeding the budget on their own are not stored.
+        void put( const Key & key, std::shared_ptr<const Entry> entry ) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _drop(key);
+            if( entry->nBytes > _budget ) return;
+            _lru.emplace_front(key, entry);
+            _index.emplace(key, _lru.begin());
+            _nBytes += entry->nBytes;
+            while( _nBytes > _budget ) {
+                _nBytes -= _lru.back().second->nBytes;
+                _index.erase(_lru.back().first);
+                _lru.pop_back();
+            }
+        }
+        /// Removes entry, if cached
+        void drop( const Key & key ) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _drop(key);
+        }
+        /// Removes all the entries of the document
+        void drop_document( const aux::Atom & docID ) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            auto it = _index.lower_bound(Key{docID, 0});
+            while( it != _index.end() && it->first.first == docID ) {
+                _nBytes -= it->second->second->nBytes;
+                _lru.erase(it->second);
+                it = _index.erase(it);
+            }
+        }
+        /// Drops all the entries (counters are kept)
+        void clear() {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _lru.clear();
+            _index.clear();
+            _nBytes = 0;
+        }
+        /// Number of lookups succeeded
+        size_t n_hits() const { std::lock_guard<std::mutex> lock(_mtx); return _nHits; }
+        /// Number of lookups failed
+        size_t n_misses() const { std::lock_guard<std::mutex> lock(_mtx); return _nMisses; }
+        /// Number of cached blocks
+        size_t n_entries() const { std::lock_guard<std::mutex> lock(_mtx); return _index.size(); }
+        /// Approximate memory in use, bytes
+        size_t n_bytes() const { std::lock_guard<std::mutex> lock(_mtx); return _nBytes; }
+        /// Memory budget, bytes
+        size_t budget() const { return _budget; }
+    };
+    /// Row cursor over in-memory (cached) block content
+    class CachedBlockCursor : public iLoader::iRowCursor {
+    private:
+        std::shared_ptr<const typename BlockCache::Entry> _entry;
+        size_t _nRow;
+        aux::RowMetaInfo _md;
+    public:
+        CachedBlockCursor( std::shared_ptr<const typename BlockCache::Entry> entry )
+            : _entry(entry)
+            , _nRow(std::numeric_limits<size_t>::max())
+            {}
+        bool next() override {
+            ++_nRow;  // wraps to 0 at first call
+            if( _nRow >= _entry->rows.size() ) {
+                _nRow = _entry->rows.size();
+                return false;
+            }
+            const auto & row = _entry->rows[_nRow];
+            _md.at(*_entry->mds[row.nMD], row.lineNo);
+            return true;
+        }
+        const aux::MetaInfo & metainfo() const override { return _md.get(); }
+        size_t line_number() const override { return _entry->rows[_nRow].lineNo; }
+        const std::string & expression() const override { return _entry->rows[_nRow].expression; }
+    };
+
+    /// Cache of pre-tokenized blocks; disabled when null
+    ///
+    /// Use `enable_block_cache()` to set it up.
+    std::shared_ptr<BlockCache> blockCache;
+
+    /// Enables pre-tokenized blocks cache with given memory budget (bytes)
+    ///
+    /// Zero budget disables the cache.
+    void enable_block_cache( size_t budgetBytes ) {
+        if( !budgetBytes ) { blockCache = nullptr; return; }
+        blockCache = std::make_shared<BlockCache>(budgetBytes);
+    }
+
+    /**\brief Binary (de)serialization of data blocks
+     *
+     * Used by persistent caches. Metadata snapshots and restart points
+     * shared between blocks are written once. Validity keys are stored with
+     * `ValidityTraits<KeyT>::to_string()` and restored with `from_string()`.
+     */
+    struct BlocksIO {
+        /// Index value denoting absent item
+        static constexpr uint64_t none = std::numeric_limits<uint64_t>::max();
+
+        /// Writes validity key (empty string if unset)
+        static void write_key( std::ostream & os, KeyT k ) {
+            aux::BinIO::write(os, ValidityTraits<KeyT>::is_set(k)
+                                ? ValidityTraits<KeyT>::to_string(k)
+                                : std::string() );
+        }
+        /// Reads validity key
+        static KeyT read_key( std::istream & is ) {
+            const std::string str = aux::BinIO::read_str(is);
+            return str.empty() ? KeyT(ValidityTraits<KeyT>::unset)
+                               : ValidityTraits<KeyT>::from_string(str);
+        }
+
+        /// Writes blocks
+        static void write( std::ostream & os, const std::vector<const DataBlock *> & blocks ) {
+            std::vector<const aux::MetaInfo *> mds;
+            std::vector<const aux::RestartPoint *> rps;
+            std::unordered_map<const aux::MetaInfo *, uint64_t> mdIdx;
+            std::unordered_map<const aux::RestartPoint *, uint64_t> rpIdx;
+            std::vector<std::pair<uint64_t, uint64_t>> refs;
+            for( const auto * block : blocks ) {
+                refs.emplace_back( _index_of(block->mdSnapshot.get(), mds, mdIdx)
+                                 , _index_of(block->restartPoint.get(), rps, rpIdx) );
+            }
+            aux::BinIO::write(os, mds.size());
+            for( const auto * md : mds ) aux::BinIO::write(os, *md);
+            aux::BinIO::write(os, rps.size());
+            for( const auto * rp : rps ) {
+                aux::BinIO::write(os, rp->offset);
+                aux::BinIO::write(os, rp->inOffset);
+                aux::BinIO::write(os, rp->bits);
+                aux::BinIO::write(os, rp->window);
+            }
+            aux::BinIO::write(os, blocks.size());
+            auto refIt = refs.begin();
+            for( const auto * block : blocks ) {
+                aux::BinIO::write(os, block->dataType);
+                write_key(os, block->validityRange.from);
+                write_key(os, block->validityRange.to);
+                aux::BinIO::write(os, block->blockBgn);
+                aux::BinIO::write(os, block->blockOffset);
+                aux::BinIO::write(os, refIt->first);
+                aux::BinIO::write(os, refIt->second);
+                ++refIt;
+            }
+        }
+
+        /// Reads blocks; returns `false` on malformed input
+        static bool read( std::istream & is, std::vector<DataBlock> & blocks ) {
+            std::vector<std::shared_ptr<const aux::MetaInfo>> mds;
+            for( uint64_t n = aux::BinIO::read_u64(is); is && n; --n ) {
+                auto mi = std::make_shared<aux::MetaInfo>();
+                aux::BinIO::read_md(is, *mi);
+                mds.push_back(mi);
+            }
+            if( !is ) return false;
+            std::vector<std::shared_ptr<const aux::RestartPoint>> rps;
+            for( uint64_t n = aux::BinIO::read_u64(is); is && n; --n ) {
+                auto p = std::make_shared<aux::RestartPoint>();
+                p->offset = aux::BinIO::read_u64(is);
+                p->inOffset = aux::BinIO::read_u64(is);
+                p->bits = aux::BinIO::read_u64(is);
+                p->window = aux::BinIO::read_str(is);
+                rps.push_back(p);
+            }
+            if( !is ) return false;
+            for( uint64_t n = aux::BinIO::read_u64(is); is && n; --n ) {
+                DataBlock block;
+                block.dataType = aux::BinIO::read_str(is);
+                block.validityRange.from = read_key(is);
+                block.validityRange.to = read_key(is);
+                block.blockBgn = aux::BinIO::read_u64(is);
+                block.blockOffset = aux::BinIO::read_u64(is);
+                const uint64_t nMD = aux::BinIO::read_u64(is)
+                             , nRP = aux::BinIO::read_u64(is);
+                if( nMD != none ) {
+                    if( nMD >= mds.size() ) return false;
+                    block.mdSnapshot = mds[nMD];
+                }
+                if( nRP != none ) {
+                    if( nRP >= rps.size() ) return false;
+                    block.restartPoint = rps[nRP];
+                }
+                blocks.push_back(block);
+            }
+            return (bool) is;
+        }
+    private:
+        /// Returns index of shared item in the list, adding it if need
+        template<typename T> static uint64_t
+        _index_of( const T * p
+                 , std::vector<const T *> & items
+                 , std::unordered_map<const T *, uint64_t> & idx
+                 ) {
+            if( !p ) return none;
+            auto ir = idx.emplace(p, items.size());
+            if( ir.second ) items.push_back(p);
+            return ir.first->second;
+        }
+    };
+
+    /// Stat info identifying document state, used to validate persistent
+    /// caches
+    struct DocState {
+        uint64_t size;
+        int64_t mtimeSec, mtimeNSec;
+
+        /// Retrieves document state, returns `false` if not a regular file
+        bool stat( const std::string & docID ) {
+            struct ::stat st;
+            if( 0 != ::stat(docID.c_str(), &st) || !S_ISREG(st.st_mode) ) return false;
+            size = st.st_size;
+            mtimeSec = st.st_mtim.tv_sec;
+            mtimeNSec = st.st_mtim.tv_nsec;
+            return true;
+        }
+        bool operator==( const DocState & o ) const {
+            return size == o.size && mtimeSec == o.mtimeSec && mtimeNSec == o.mtimeNSec;
+        }
+    };
+
+    /**\brief Persistent cache of the documents structure
+     *
+     * Keeps result of `iLoader::get_doc_struct()` (data blocks with
+     * positional markup, metadata snapshots and restart points) in a file,
+     * so that subsequent `add()` of unchanged document does not need to
+     * pre-parse it. Cache file is put next to the document (with `.sdcidx`
+     * suffix) or in the dedicated directory.
+     *
+     * Cache entry is valid if loader's fingerprint (see
+     * `iLoader::structure_fingerprint()`) and document's size are the same
+     * and either modification time or the content hash is the same (so
+     * that touched documents are not re-parsed). Stale entries are
+     * overwritten. Documents that are not files (e.g. ones provided by
+     * `BinaryLoader`) are not cached.
+     *
+     * Failure to write the cache file (e.g. due to permissions) is ignored.
+     */
+    class StructureCache {
+    public:
+        /// Directory to keep cache files in; if empty, cache files are put
+        /// next to the documents
+        std::string dir;
+        /// If set, content hash is verified even if modification time is
+        /// the same
+        bool alwaysVerifyHash;
+    private:
+        /// Lookups counters
+        size_t _nHits, _nMisses, _nStale;
+        /// Magic bytes (and format version) of the cache file
+        static constexpr char _magic[8] = {'S', 'D', 'C', 'I', 'D', 'X', '0', '1'};
+
+        /// Writes cache file
+        void _write( const std::string & docID
+                   , const std::string & fingerprint
+                   , const DocState & ds
+                   , uint64_t hash
+                   , const std::list<DataBlock> & blocks
+                   ) const {
+            const std::string path = path_for(docID)
+                            , tmpPath = path + "." + std::to_string(getpid()) + ".tmp"
+                            ;
+            {
+                std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+                if( !os ) return;
+                os.write(_magic, sizeof(_magic));
+                aux::BinIO::write(os, fingerprint);
+                aux::BinIO::write(os, ds.size);
+                aux::BinIO::write(os, ds.mtimeSec);
+                aux::BinIO::write(os, ds.mtimeNSec);
+                aux::BinIO::write(os, hash);
+                std::vector<const DataBlock *> ptrs;
+                for( const auto & block : blocks ) ptrs.push_back(&block);
+                BlocksIO::write(os, ptrs);
+                if( !os ) {
+                    os.close();
+                    remove(tmpPath.c_str());
+                    return;
+                }
+            }
+            if( 0 != rename(tmpPath.c_str(), path.c_str()) )
+                remove(tmpPath.c_str());
+        }
+    public:
+        StructureCache( const std::string & dir_="" ) : dir(dir_)
+                                                      , alwaysVerifyHash(false)
+                                                      , _nHits(0)
+                                                      , _nMisses(0)
+                                                      , _nStale(0)
+                                                      {}
+
+        /// Returns path of the cache file for the document
+        std::string path_for( const std::string & docID ) const {
+            if( dir.empty() ) return docID + ".sdcidx";
+            // FNV-1a of the document path
+            uint64_t h = 14695981039346656037ULL;
+            for( unsigned char c : docID ) { h ^= c; h *= 1099511628211ULL; }
+            std::ostringstream oss;
+            oss << dir << (dir.back() == '/' ? "" : "/")
+                << std::hex << std::setw(16) << std::setfill('0') << h << ".sdcidx";
+            return oss.str();
+        }
+
+        /**\brief Retrieves document structure from cache
+         *
+         * Returns `false` if there is no valid cache entry for the document.
+         * Malformed cache files are considered as stale.
+         *
+         * Cache file is opened read-only, so that caches on read-only (or
+         * shared) storage can be used. It is re-opened for writing only to
+         * update the modification time of touched document; failure to
+         * do so is ignored.
+         */
+        bool get( const std::string & docID
+                , const std::string & fingerprint
+                , std::list<DataBlock> & blocks
+                ) {
+            DocState ds;
+            if( !ds.stat(docID) ) return false;
+            const std::string path = path_for(docID);
+            std::ifstream fs(path, std::ios::binary);
+            if( !fs ) { ++_nMisses; return false; }
+            char magic[sizeof(_magic)];
+            fs.read(magic, sizeof(magic));
+            if( !fs || 0 != memcmp(magic, _magic, sizeof(magic))
+             || aux::BinIO::read_str(fs) != fingerprint
+             || aux::BinIO::read_u64(fs) != ds.size ) {
+                ++_nStale;
+                return false;
+            }
+            const std::streampos mtimePos = fs.tellg();
+            const int64_t mtimeSec = aux::BinIO::read_u64(fs)
+                        , mtimeNSec = aux::BinIO::read_u64(fs)
+                        ;
+            const uint64_t hash = aux::BinIO::read_u64(fs);
+            const bool sameMTime = mtimeSec == ds.mtimeSec && mtimeNSec == ds.mtimeNSec;
+            if( !fs || ( (!sameMTime || alwaysVerifyHash)
+                      && hash != aux::file_hash(docID) ) ) {
+                ++_nStale;
+                return false;
+            }
+            std::vector<DataBlock> read;
+            try {
+                if( !BlocksIO::read(fs, read) ) {
+                    ++_nStale;
+                    return false;
+                }
+            } catch( std::exception & ) {  // e.g. bad validity key
+                ++_nStale;
+                return false;
+            }
+            blocks.assign(read.begin(), read.end());
+            if( !sameMTime ) {
+                // document was touched -- update modification time
+                fs.close();
+                std::fstream ofs(path, std::ios::binary | std::ios::in | std::ios::out);
+                if( ofs ) {
+                    ofs.seekp(mtimePos);
+                    aux::BinIO::write(ofs, ds.mtimeSec);
+                    aux::BinIO::write(ofs, ds.mtimeNSec);
+                }
+            }
+            ++_nHits;
+            return true;
+        }
+
+        /// Stores document structure in cache (if document is a file)
+        void put( const std::string & docID
+                , const std::string & fingerprint
+                , const std::list<DataBlock> & blocks
+                ) const {
+            DocState ds;
+            if( !ds.stat(docID) ) return;
+            _write(docID, fingerprint, ds, aux::file_hash(docID), blocks);
+        }
+
+        /// Number of valid entries found
+        size_t n_hits() const { return _nHits; }
+        /// Number of documents without cache entry
+        size_t n_misses() const { return _nMisses; }
+        /// Number of invalid entries found (re-parsed)
+        size_t n_stale() const { return _nStale; }
+    };
+
+    /// Magic bytes (and format version) of the index snapshot file
+    static constexpr char _snapshotMagic[8] = {'S', 'D', 'C', 'S', 'N', 'P', '0', '1'};
+
+    /// If set, loading routines hint loaders on documents to be read
+    /// before reading starts (see `iLoader::prefetch()`)
+    bool prefetchDocuments = true;
+
+    /// Persistent cache of documents structure; disabled when null
+    ///
+    /// Use `enable_structure_cache()` to set it up.
+    std::shared_ptr<StructureCache> structureCache;
+
+    /// Enables persistent cache of documents structure
+    ///
+    /// Cache files are put in the given directory, or next to the documents
+    /// if directory is empty.
+    void enable_structure_cache( const std::string & dir="" ) {
+        structureCache = std::make_shared<StructureCache>(dir);
+    }
+
+    typedef typename ValidityIndex<KeyT, DocumentLoadingState>::Updates::value_type Update;
+protected:
+    /// Number of index modifications
+    size_t _generation = 0;
+    /// Number of index modifications, by data type
+    std::unordered_map<aux::Atom, size_t, aux::Atom::Hash> _typeGenerations;
+
+    /// Returns interned name of the calibration data type
+    template<typename T> static const aux::Atom &
+    _type_atom() {
+        static const aux::Atom typeAtom(CalibDataTraits<T>::typeName);
+        return typeAtom;
+    }
+
+    /// Increments modification counters for the data type
+    void _touch_type( const aux::Atom & typeName ) {
+        ++_generation;
+        ++_typeGenerations[typeName];
+    }
+
+    /// Hints loaders on the documents to be read for the updates
+    ///
+    /// Documents are hinted in order of their first appearance in the
+    /// updates lists.
+    template<typename ... UpdatesTs> void
+    _prefetch( const UpdatesTs & ... updatesLists ) const {
+        if( !prefetchDocuments ) return;
+        typedef std::pair<aux::Atom, iLoader *> DocKey;
+        std::vector<std::pair<DocKey, std::vector<const DataBlock *>>> docs;
+        std::map<DocKey, size_t> docIdx;
+        auto collect = [&]( const Update & upd ) {
+                const DocKey key(upd.second->docID, upd.second->auxInfo.loader.get());
+                auto ir = docIdx.emplace(key, docs.size());
+                if( ir.second ) docs.emplace_back(key, std::vector<const DataBlock *>());
+                docs[ir.first->second].second.push_back(&upd.second->auxInfo.dataBlock);
+            };
+        ( std::for_each(updatesLists.begin(), updatesLists.end(), collect), ... );
+        for( const auto & doc : docs ) {
+            std::lock_guard<std::recursive_mutex> lock(doc.first.second->readMutex);
+            doc.first.second->prefetch(doc.first.first, doc.second);
+        }
+    }
+
+    /// Returns loading state of (any) index entry of the document, if any
+    std::optional<DocumentLoadingState>
+    _loading_state_of( const aux::Atom & docID ) const {
+        for( const auto & typeEntry : validityIndex._types ) {
+            for( const auto & p : typeEntry.second ) {
+                if( p.second.docID == docID ) return p.second.auxInfo;
+            }
+        }
+        return std::nullopt;
+    }
+    template<typename S> aux::if_string_like_t<S, std::optional<DocumentLoadingState>>
+    _loading_state_of( const S & docID ) const {
+        const auto atom = aux::Atom::find(docID);
+        if( !atom ) return std::nullopt;
+        return _loading_state_of(*atom);
+    }
+
+    /// Runs row parsing/collecting callable, wrapping errors with the
+    /// row's source information
+    template<typename CallableT> static void
+    _guarded_row( size_t lineNo
+                , const std::string & expression
+                , const std::string & docID
+                , CallableT && f
+                ) {
+        try {
+            f();
+        } catch( errors::RuntimeError & e ) {
+            throw errors::NestedError<errors::ParserError>( e
+                , "while parsing or collecting data block"
+                , expression
+                , docID
+                , lineNo
+                );
+        }
+    }
+
+    /// Reads block, using block cache if possible
+    void
+    _read_block_cached( const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry & de
+                      , KeyT forKey
+                      , const std::string & forType
+                      , typename iLoader::ReaderCallback cllb
+                      ) const {
+        iLoader * loaderPtr = de.auxInfo.loader.get();
+        if( !(blockCache && loaderPtr->cacheable_blocks()) ) {
+            loaderPtr->read_block(de.docID, forKey, forType, de.auxInfo.dataBlock, cllb);
+            return;
+        }
+        const typename BlockCache::Key cacheKey{de.docID, de.auxInfo.dataBlock.blockBgn};
+        auto cached = blockCache->get(cacheKey);
+        if( cached ) {
+            cached->replay(cllb);
+            return;
+        }
+        auto entry = std::make_shared<typename BlockCache::Entry>();
+        bool complete = true;
+        loaderPtr->read_block( de.docID, forKey, forType, de.auxInfo.dataBlock
+                , [&]( const aux::MetaInfo & meta
+                     , size_t lineNo
+                     , const std::string & expression ) {
+                    entry->add(meta, lineNo, expression);
+                    return complete = cllb(meta, lineNo, expression);
+                } );
+        if( complete ) blockCache->put(cacheKey, entry);
+    }
+
+    /// Opens cursor over the block rows, using block cache if possible
+    std::unique_ptr<typename iLoader::iRowCursor>
+    _open_block_cursor( const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry & de
+                      , KeyT forKey
+                      , const std::string & forType
+                      ) const {
+        iLoader * loaderPtr = de.auxInfo.loader.get();
+        if( blockCache && loaderPtr->cacheable_blocks() ) {
+            auto cached = blockCache->get({de.docID, de.auxInfo.dataBlock.blockBgn});
+            if( cached ) {
+                return std::unique_ptr<typename iLoader::iRowCursor>(
+                        new CachedBlockCursor(cached) );
+            }
+        }
+        std::unique_ptr<typename iLoader::iRowCursor> r;
+        _with_doc_defaults( de, *loaderPtr, [&](){
+                r = loaderPtr->open_block( de.docID, forKey, forType, de.auxInfo.dataBlock );
+            } );
+        return r;
+    }
+
+    /// Runs callable with loader defaults set to ones saved for the document
+    /// entry, restoring them afterwards and appending document ID to errors,
+    /// if need
+    template<typename CallableT> static void
+    _with_doc_defaults( const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry & de
+                      , iLoader & loader
+                      , CallableT && f
+                      ) {
+        std::lock_guard<std::recursive_mutex> lock(loader.readMutex);
+        // copy of loader's defaults to be restored
+        const typename iLoader::Defaults dftsBck = loader.defaults;
+        loader.defaults = de.auxInfo.docDefaults;
+        try {
+            f();
+        } catch( errors::ParserError & e ) {
+            if( e.docID.empty() ) e.docID = de.docID;
+            loader.defaults = dftsBck;
+            throw;
+        } catch( errors::IOError & e ) {
+            if( e.filename.empty() ) e.filename = de.docID;
+            loader.defaults = dftsBck;
+            throw;
+        } catch(...) {
+            loader.defaults = dftsBck;
+            throw;
+        }
+        loader.defaults = dftsBck;
+    }
+
+    /// Advances block cursor, appending document ID to errors, if need
+    static bool
+    _cursor_next( typename iLoader::iRowCursor & cursor, const std::string & docID ) {
+        try {
+            return cursor.next();
+        } catch( errors::ParserError & e ) {
+            if( e.docID.empty() ) e.docID = docID;
+            throw;
+        } catch( errors::IOError & e ) {
+            if( e.filename.empty() ) e.filename = docID;
+            throw;
+        }
+    }
+
+    /// Per-type state of multiple types loading
+    ///
+    /// Keeps track on which updates were already applied to the collection.
+    /// Rows of updates read ahead of their order are buffered and applied
+    /// once all the preceding updates are done.
+    template<typename T>
+    struct MultiLoadState {
+        typedef typename CalibDataTraits<T>::template Collection<> Collection;
+        /// Rows of an update read ahead of order
+        struct Buffered {
+            /// Metadata snapshots in effect for the rows
+            std::vector< std::shared_ptr<const aux::MetaInfo> > mds;
+            /// Parsed item, line number, metadata snapshot index
+            std::vector< std::tuple<T, size_t, size_t> > rows;
+        };
+        /// Destination collection
+        Collection & dest;
+        /// Updates to apply, in order
+        std::vector<Update> updates;
+        /// Rows read ahead of order, by update number
+        std::vector< std::unique_ptr<Buffered> > buffered;
+        /// Whether update was read
+        std::vector<bool> done;
+        /// Number of update to be applied next
+        size_t nextToApply;
+
+        MultiLoadState( Collection & dest_
+                      , const typename ValidityIndex<KeyT, DocumentLoadingState>::Updates & upds
+                      ) : dest(dest_)
+                        , updates(upds.begin(), upds.end())
+                        , buffered(upds.size())
+                        , done(upds.size(), false)
+                        , nextToApply(0)
+                        {}
+
+        /// Applies item to collection, or buffers it if update is read
+        /// ahead of order
+        void consume( size_t nUpd
+                    , T && item
+                    , const aux::MetaInfo & md
+                    , size_t lineNo
+                    ) {
+            if( nUpd == nextToApply ) {
+                CalibDataTraits<T>::collect(dest, item, md, lineNo);
+                return;
+            }
+            auto & b = buffered[nUpd];
+            if( !b ) b.reset(new Buffered);
+            // metadata may only grow while block is read
+            if( b->mds.empty() || b->mds.back()->size() != md.size() )
+                b->mds.push_back(std::make_shared<const aux::MetaInfo>(md));
+            b->rows.emplace_back(std::move(item), lineNo, b->mds.size() - 1);
+        }
+
+        /// Marks update as read, applies buffered ones that became current
+        void mark_done( size_t nUpd ) {
+            done[nUpd] = true;
+            while( nextToApply < done.size() && done[nextToApply] ) {
+                auto & b = buffered[nextToApply];
+                if( b ) {
+                    aux::RowMetaInfo md;
+                    for( auto & row : b->rows ) {
+                        CalibDataTraits<T>::collect( dest, std::get<0>(row)
+                                , md.at(*b->mds[std::get<2>(row)], std::get<1>(row))
+                                , std::get<1>(row) );
+                    }
+                    b.reset();
+                }
+                ++nextToApply;
+            }
+        }
+    };
+
+    /// Document to be read within multiple types loading
+    struct DocumentReads {
+        /// Document ID
+        aux::Atom docID;
+        /// Loader to use
+        iLoader * loaderPtr;
+        /// Blocks to read
+        std::vector<typename iLoader::BlockRead> reads;
+        /// Type number and update number corresponding to the reads
+        std::vector< std::pair<size_t, size_t> > marks;
+        /// Blocks being recorded for the cache
+        std::vector< std::pair< typename BlockCache::Key
+                              , std::shared_ptr<typename BlockCache::Entry>
+                              > > toCache;
+        /// Cached block to be forwarded instead of reading (if set)
+        std::shared_ptr<const typename BlockCache::Entry> cached;
+    };
+
+    /// Appends block read of the update to the document's reads list
+    template<typename T> void
+    _enqueue_update( MultiLoadState<T> & state
+                   , size_t nType
+                   , size_t nUpd
+                   , aux::LoadLog * loadLogPtr
+                   , std::list<DocumentReads> & docReads
+                   , std::map< std::pair<aux::Atom, iLoader *>
+                             , DocumentReads * > & byDoc
+                   ) const {
+        if( nUpd >= state.updates.size() ) return;
+        const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry *
+            docEntryPtr = state.updates[nUpd].second;
+        iLoader * loaderPtr = docEntryPtr->auxInfo.loader.get();
+        const aux::Atom & docID = docEntryPtr->docID;
+        typename iLoader::ReaderCallback cllb
+                = [&state, nUpd, &docID, loadLogPtr]( const aux::MetaInfo & meta
+                                                    , size_t lineNo
+                                                    , const std::string & expression ) {
+                    if(loadLogPtr) loadLogPtr->set_source(docID, lineNo);
+                    _guarded_row(lineNo, expression, docID, [&](){
+                            state.consume( nUpd
+                                         , parse_row<T>( expression
+                                                , RowContext{lineNo, docID, meta, loadLogPtr} )
+                                         , meta, lineNo );
+                        });
+                    if(loadLogPtr) loadLogPtr->set_source("(none)", 0);
+                    return true;
+                };
+        const bool useCache = blockCache && loaderPtr->cacheable_blocks();
+        const typename BlockCache::Key cacheKey{docID, docEntryPtr->auxInfo.dataBlock.blockBgn};
+        if( useCache ) {
+            auto cached = blockCache->get(cacheKey);
+            if( cached ) {
+                // forward cached rows in place of the document reading
+                docReads.push_back(DocumentReads{docID, nullptr, {}, {}, {}, cached});
+                docReads.back().reads.push_back(typename iLoader::BlockRead{
+                        CalibDataTraits<T>::typeName, nullptr, nullptr, cllb });
+                docReads.back().marks.push_back({nType, nUpd});
+                return;
+            }
+        }
+        auto ir = byDoc.emplace( std::make_pair(docID, loaderPtr), nullptr );
+        if( ir.second ) {
+            docReads.push_back(DocumentReads{docID, loaderPtr, {}, {}, {}, nullptr});
+            ir.first->second = &docReads.back();
+        }
+        DocumentReads & dr = *ir.first->second;
+        if( useCache ) {
+            // record rows for the cache while forwarding them
+            auto entry = std::make_shared<typename BlockCache::Entry>();
+            dr.toCache.emplace_back(cacheKey, entry);
+            cllb = [entry, cllb]( const aux::MetaInfo & meta
+                                , size_t lineNo
+                                , const std::string & expression ) {
+                    entry->add(meta, lineNo, expression);
+                    return cllb(meta, lineNo, expression);
+                };
+        }
+        dr.reads.push_back( typename iLoader::BlockRead{
+                  CalibDataTraits<T>::typeName
+                , &docEntryPtr->auxInfo.dataBlock
+                , &docEntryPtr->auxInfo.docDefaults
+                , cllb
+            });
+        dr.marks.push_back({nType, nUpd});
+    }
+
+    /// Loads multiple types into tuple of collections
+    template<typename ... Ts, typename DestsT, size_t ... Is> void
+    _load_multiple( DestsT & dests
+                  , KeyT key
+                  , bool noTypeIsOk
+                  , aux::LoadLog * loadLogPtr
+                  , std::index_sequence<Is...>
+                  ) const {
+        std::tuple< MultiLoadState<Ts>... > states( MultiLoadState<Ts>(
+                      std::get<Is>(dests)
+                    , validityIndex.updates(_type_atom<Ts>(), key, noTypeIsOk)
+                    )... );
+        // Collect reads, grouped by documents. Documents are ordered
+        // round-robin by update number, so that buffering of the rows
+        // read ahead of order is minimized.
+        _prefetch(std::get<Is>(states).updates...);
+        std::list<DocumentReads> docReads;
+        std::map< std::pair<aux::Atom, iLoader *>, DocumentReads * > byDoc;
+        const size_t nMaxUpdates = std::max({std::get<Is>(states).updates.size()...});
+        for( size_t nUpd = 0; nUpd < nMaxUpdates; ++nUpd ) {
+            ( _enqueue_update<Ts>( std::get<Is>(states), Is, nUpd
+                                 , loadLogPtr, docReads, byDoc ), ... );
+        }
+        // read documents, each one with single call
+        for( DocumentReads & dr : docReads ) {
+            if( dr.cached ) {
+                dr.cached->replay(dr.reads.front().cllb);
+            } else {
+                _read_document_blocks(dr, key);
+            }
+            for( const auto & mark : dr.marks ) {
+                ( (Is == mark.first ? std::get<Is>(states).mark_done(mark.second)
+                                    : (void) 0), ... );
+            }
+        }
+    }
+
+    /// Reads blocks of single document within multiple types loading
+    void
+    _read_document_blocks( DocumentReads & dr, KeyT key ) const {
+        std::lock_guard<std::recursive_mutex> lock(dr.loaderPtr->readMutex);
+        // copy of loader's defaults to be restored
+        const typename iLoader::Defaults dftsBck = dr.loaderPtr->defaults;
+        try {
+            dr.loaderPtr->read_blocks(dr.docID, key, dr.reads);
+        } catch( errors::ParserError & e ) {
+            if( e.docID.empty() ) e.docID = dr.docID;
+            dr.loaderPtr->defaults = dftsBck;
+            throw;
+        } catch( errors::IOError & e ) {
+            if( e.filename.empty() ) e.filename = dr.docID;
+            dr.loaderPtr->defaults = dftsBck;
+            throw;
+        } catch(...) {
+            dr.loaderPtr->defaults = dftsBck;
+            throw;
+        }
+        dr.loaderPtr->defaults = dftsBck;
+        for( auto & p : dr.toCache ) {
+            blockCache->put(p.first, p.second);
+        }
+    }
+public:
+    // TODO: doc
+    template<typename T> void
+    load_update_into( const typename ValidityIndex< KeyT
+                                                  , DocumentLoadingState
+                                                  >::Updates::value_type upd
+                    , typename CalibDataTraits<T>::template Collection<> & dest
+                    , KeyT forKey
+                    , aux::LoadLog * loadLogPtr=nullptr
+                    ) const {
+        aux::ArenaScope arenaScope;
+        // doc entry to read (has docID, valid-to, auxinfo which is of this
+        // class' DocumentLoadingState -- defaults+loader )
+        const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry *
+            docEntryPtr = upd.second;
+        // particular loader ptr
+        iLoader *
+            loaderPtr = docEntryPtr->auxInfo.loader.get();
+        std::lock_guard<std::recursive_mutex> lock(loaderPtr->readMutex);
+        // copy of loader's defaults to be restored
+        const typename iLoader::Defaults dftsBck = loaderPtr->defaults;
+        // set metadata to one saved on pre-parsing
+        loaderPtr->defaults = docEntryPtr->auxInfo.docDefaults;
+        // Here static and dynamic polymorphism join.
+        // We use C++ lambda function to make runtime-polymorphic handler
+        // to read the data into statically-derived data structure.
+        try {
+            _read_block_cached( *docEntryPtr
+                  , forKey
+                  , CalibDataTraits<T>::typeName
+                  , [&]( const typename aux::MetaInfo & meta
+                       , size_t lineNo
+                       , const std::string & expression ) {
+                            if(loadLogPtr) loadLogPtr->set_source(docEntryPtr->docID, lineNo);
+                            _guarded_row(lineNo, expression, docEntryPtr->docID, [&](){
+                                CalibDataTraits<T>::collect( dest
+                                        , parse_row<T>( expression
+                                              , RowContext{ lineNo
+                                                          , docEntryPtr->docID
+                                                          , meta
+                                                          , loadLogPtr
+                                                          } )
+                                        , meta
+                                        , lineNo
+                                        );
+                                });
                             if(loadLogPtr) loadLogPtr->set_source("(none)", 0);
                             return true;
                         }
@@ -2384,6 +5754,61 @@ public:
         }
         loaderPtr->defaults = dftsBck;
     }
+
+    /**\brief Loads single update using statically dispatched loader
+     *
+     * Version of `load_update_into()` for the concrete loader type `LoaderT`
+     * that must provide template method `read_block_static()` (see
+     * `ExtCSVLoader::read_block_static()`). Rows are forwarded to the inlined
+     * callback, without `std::function` and virtual calls on the way.
+     *
+     * If document's loader is not exactly of `LoaderT` type (or block cache
+     * is enabled for it) falls back to `load_update_into()`. Subclasses of
+     * `LoaderT` are not read statically as they may override the virtual
+     * reading methods that `read_block_static()` would bypass.
+     */
+    template<typename T, typename LoaderT> void
+    load_update_into_static( const typename ValidityIndex< KeyT
+                                                         , DocumentLoadingState
+                                                         >::Updates::value_type upd
+                           , typename CalibDataTraits<T>::template Collection<> & dest
+                           , KeyT forKey
+                           , aux::LoadLog * loadLogPtr=nullptr
+                           ) const {
+        aux::ArenaScope arenaScope;
+        const typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry &
+            de = *upd.second;
+        iLoader * basePtr = de.auxInfo.loader.get();
+        LoaderT * loaderPtr = basePtr && typeid(*basePtr) == typeid(LoaderT)
+                            ? static_cast<LoaderT *>(basePtr)
+                            : nullptr;
+        if( (!loaderPtr) || (blockCache && loaderPtr->cacheable_blocks()) ) {
+            load_update_into<T>(upd, dest, forKey, loadLogPtr);
+            return;
+        }
+        std::string expression;  // re-used buffer
+        auto cllb = [&]( const aux::MetaInfo & meta
+                       , size_t lineNo
+                       , std::string_view line ) {
+                expression.assign(line.data(), line.size());
+                if(loadLogPtr) loadLogPtr->set_source(de.docID, lineNo);
+                _guarded_row(lineNo, expression, de.docID, [&](){
+                    CalibDataTraits<T>::collect( dest
+                            , parse_row<T>( expression
+                                  , RowContext{lineNo, de.docID, meta, loadLogPtr} )
+                            , meta
+                            , lineNo
+                            );
+                    });
+                if(loadLogPtr) loadLogPtr->set_source("(none)", 0);
+                return true;
+            };
+        _with_doc_defaults( de, *loaderPtr, [&](){
+                loaderPtr->read_block_static( de.docID, forKey
+                        , CalibDataTraits<T>::typeName, de.auxInfo.dataBlock
+                        , cllb );
+            } );
+    }
 public:
     /**\brief Add new entry to the validity index pre-parsing its meta
      *
@@ -2434,8 +5859,19 @@ public:
             loader->defaults.validityRange = defaultValidity.second;
         if(mi.first)
             loader->defaults.baseMD = mi.second;
+        // cached blocks of the document (if any) are not valid anymore
+        if( blockCache ) blockCache->drop_document(docID);
         try {
-            const auto docStruct = loader->get_doc_struct(docID);
+            std::list<DataBlock> docStruct;
+            if( structureCache ) {
+                const std::string fingerprint = loader->structure_fingerprint();
+                if( !structureCache->get(docID, fingerprint, docStruct) ) {
+                    docStruct = loader->get_doc_struct(docID);
+                    structureCache->put(docID, fingerprint, docStruct);
+                }
+            } else {
+                docStruct = loader->get_doc_struct(docID);
+            }
             for( const auto & block : docStruct ) {
                 // Get data type
                 if( block.dataType.empty() ) {
@@ -2461,8 +5897,9 @@ public:
                                        , block.dataType  // data type
                                        , block.validityRange.from
                                        , block.validityRange.to
-                                       , DocumentLoadingState{loader->defaults, loader, block.blockBgn }
+                                       , DocumentLoadingState{loader->defaults, loader, block }
                                        );
+                _touch_type(block.dataType);
             }
             loader->defaults = prevDfts;
             return !docStruct.empty();
@@ -2537,24 +5974,627 @@ public:
         return nAdded;
     }
 
-    ///\brief Loads calibration data entries, in "overlay mode"
-    ///
-    /// This methood queries indexes for "still valid" data of certain type
-    /// (see `ValidityIndex::updates()`) and performs sequential loading of
-    /// those entries.
-    ///
-    /// Useful for partially-defined data that must be updated incrementally.
-    template<typename T> typename CalibDataTraits<T>::template Collection<>
-    load( KeyT key, bool noTypeIsOk=false, aux::LoadLog * loadLogPtr=nullptr) const {
-        typename CalibDataTraits<T>::template Collection<> dest;
-        const auto updates = validityIndex.updates(
-                CalibDataTraits<T>::typeName, key, noTypeIsOk );
-        for( const auto & upd : updates ) {
-            load_update_into<T>(upd, dest, key, loadLogPtr);
+    /**\brief Saves the whole validity index into a snapshot file
+     *
+     * Snapshot keeps all the index entries (types, validity ranges, data
+     * blocks structure and defaults in effect) with documents' state, so
+     * that `restore_snapshot()` can recover the index without even
+     * accessing the documents. Loaders are referenced by their position in
+     * `loaders` list (and type, to check it on restore).
+     *
+     * File is written to temporary location and then renamed, so concurrent
+     * readers never see partially written snapshot.
+     *
+     * \throws `sdc::errors::IOError` if snapshot can not be written.
+     * */
+    void save_snapshot( const std::string & path ) const {
+        std::vector<aux::Atom> docIDs;
+        std::unordered_map<aux::Atom, uint64_t, aux::Atom::Hash> docIdx;
+        std::vector<const DataBlock *> blocks;
+        for( const auto & typeEntry : validityIndex._types ) {
+            for( const auto & p : typeEntry.second ) {
+                if( docIdx.emplace(p.second.docID, docIDs.size()).second )
+                    docIDs.push_back(p.second.docID);
+                blocks.push_back(&p.second.auxInfo.dataBlock);
+            }
+        }
+        const std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+            if( !os ) throw errors::IOError(path, "can not write snapshot file");
+            os.write(_snapshotMagic, sizeof(_snapshotMagic));
+            aux::BinIO::write(os, typeid(KeyT).name());
+            // loaders
+            aux::BinIO::write(os, loaders.size());
+            for( const auto & loader : loaders )
+                aux::BinIO::write(os, typeid(*loader).name());
+            // documents with their state
+            aux::BinIO::write(os, docIDs.size());
+            for( const auto & docID : docIDs ) {
+                DocState ds;
+                const bool isFile = ds.stat(docID);
+                aux::BinIO::write(os, docID);
+                aux::BinIO::write(os, isFile ? 1 : 0);
+                aux::BinIO::write(os, isFile ? ds.size : 0);
+                aux::BinIO::write(os, isFile ? ds.mtimeSec : 0);
+                aux::BinIO::write(os, isFile ? ds.mtimeNSec : 0);
+            }
+            // data blocks, in the same order as entries below
+            BlocksIO::write(os, blocks);
+            // index entries
+            aux::BinIO::write(os, validityIndex._types.size());
+            for( const auto & typeEntry : validityIndex._types ) {
+                aux::BinIO::write(os, typeEntry.first);
+                aux::BinIO::write(os, typeEntry.second.size());
+                for( const auto & p : typeEntry.second ) {
+                    const auto & dls = p.second.auxInfo;
+                    BlocksIO::write_key(os, p.first);
+                    aux::BinIO::write(os, docIdx[p.second.docID]);
+                    BlocksIO::write_key(os, p.second.validTo);
+                    aux::BinIO::write(os, dls.docDefaults.dataType);
+                    BlocksIO::write_key(os, dls.docDefaults.validityRange.from);
+                    BlocksIO::write_key(os, dls.docDefaults.validityRange.to);
+                    aux::BinIO::write(os, dls.docDefaults.baseMD);
+                    auto it = std::find(loaders.begin(), loaders.end(), dls.loader);
+                    aux::BinIO::write(os, it == loaders.end()
+                                        ? BlocksIO::none
+                                        : (uint64_t) std::distance(loaders.begin(), it) );
+                }
+            }
+            if( !os ) {
+                os.close();
+                remove(tmpPath.c_str());
+                throw errors::IOError(path, "can not write snapshot file");
+            }
+        }
+        if( 0 != rename(tmpPath.c_str(), path.c_str()) ) {
+            remove(tmpPath.c_str());
+            throw errors::IOError(path, "can not write snapshot file");
+        }
+    }
+
+    /**\brief Restores validity index from the snapshot file
+     *
+     * Replaces current index with one saved by `save_snapshot()`. Loaders
+     * list must be the same (by types and order) as at the moment of saving.
+     * Then cheap validation pass is performed: documents which size or
+     * modification time has changed are re-indexed (with `add()`, using
+     * defaults and loader they were added with), vanished documents are
+     * removed from the index. New documents are not discovered.
+     *
+     * Returns `false` (leaving the index intact) if snapshot file does not
+     * exist, is malformed or does not match the loaders list. Entries that
+     * were added with loaders not in the `loaders` list can not be restored,
+     * so snapshots having them are refused as well.
+     * */
+    bool restore_snapshot( const std::string & path ) {
+        std::ifstream is(path, std::ios::binary);
+        if( !is ) return false;
+        char magic[sizeof(_snapshotMagic)];
+        is.read(magic, sizeof(magic));
+        if( !is || 0 != memcmp(magic, _snapshotMagic, sizeof(magic))
+         || aux::BinIO::read_str(is) != typeid(KeyT).name()
+         || aux::BinIO::read_u64(is) != loaders.size() ) return false;
+        std::vector<std::shared_ptr<iLoader>> snLoaders(loaders.begin(), loaders.end());
+        for( const auto & loader : snLoaders ) {
+            if( aux::BinIO::read_str(is) != typeid(*loader).name() ) return false;
+        }
+        struct Doc { std::string docID; bool isFile; DocState ds; };
+        std::vector<Doc> docs;
+        for( uint64_t n = is ? aux::BinIO::read_u64(is) : 0; is && n; --n ) {
+            Doc doc;
+            doc.docID = aux::BinIO::read_str(is);
+            doc.isFile = aux::BinIO::read_u64(is);
+            doc.ds.size = aux::BinIO::read_u64(is);
+            doc.ds.mtimeSec = aux::BinIO::read_u64(is);
+            doc.ds.mtimeNSec = aux::BinIO::read_u64(is);
+            docs.push_back(doc);
+        }
+        ValidityIndex<KeyT, DocumentLoadingState> restored;
+        try {
+            std::vector<DataBlock> blocks;
+            if( !is || !BlocksIO::read(is, blocks) ) return false;
+            auto blockIt = blocks.begin();
+            for( uint64_t nTypes = aux::BinIO::read_u64(is); nTypes; --nTypes ) {
+                const std::string typeName = aux::BinIO::read_str(is);
+                for( uint64_t n = aux::BinIO::read_u64(is); n; --n ) {
+                    if( !is || blockIt == blocks.end() ) return false;
+                    const KeyT from = BlocksIO::read_key(is);
+                    const uint64_t nDoc = aux::BinIO::read_u64(is);
+                    const KeyT to = BlocksIO::read_key(is);
+                    typename iLoader::Defaults dfts;
+                    dfts.dataType = aux::BinIO::read_str(is);
+                    dfts.validityRange.from = BlocksIO::read_key(is);
+                    dfts.validityRange.to = BlocksIO::read_key(is);
+                    aux::BinIO::read_md(is, dfts.baseMD);
+                    const uint64_t nLoader = aux::BinIO::read_u64(is);
+                    if( !is || nDoc >= docs.size() || nLoader >= snLoaders.size() )
+                        return false;
+                    restored.add_entry( docs[nDoc].docID, typeName, from, to
+                            , DocumentLoadingState{dfts, snLoaders[nLoader], *(blockIt++)} );
+                }
+            }
+            if( !is || blockIt != blocks.end() ) return false;
+        } catch( std::exception & ) {  // e.g. bad validity key
+            return false;
+        }
+        for( const auto & typeEntry : validityIndex._types ) _touch_type(typeEntry.first);
+        std::swap(validityIndex, restored);
+        for( const auto & typeEntry : validityIndex._types ) _touch_type(typeEntry.first);
+        if( blockCache ) blockCache->clear();
+        // validate documents state, re-index changed ones
+        for( const auto & doc : docs ) {
+            if( !doc.isFile ) continue;
+            DocState ds;
+            if( !ds.stat(doc.docID) ) {
+                drop_document(doc.docID);
+            } else if( !(ds == doc.ds) ) {
+                reindex(doc.docID);
+            }
+        }
+        return true;
+    }
+
+    /**\brief Removes document from the index
+     *
+     * All the index entries of the document are removed, as well as its
+     * blocks cached in `blockCache`. Returns number of removed entries.
+     * */
+    size_t drop_document( const aux::Atom & docID ) {
+        for( const auto & typeEntry : validityIndex._types ) {
+            for( const auto & p : typeEntry.second ) {
+                if( p.second.docID != docID ) continue;
+                _touch_type(typeEntry.first);
+                break;
+            }
+        }
+        if( blockCache ) blockCache->drop_document(docID);
+        return validityIndex.remove_document(docID);
+    }
+    /// Same as `drop_document()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, size_t>
+    drop_document( const S & docID ) {
+        const auto atom = aux::Atom::find(docID);
+        return atom ? drop_document(*atom) : 0;
+    }
+
+    /**\brief Re-indexes (changed) document
+     *
+     * Drops entries of the document and adds it again, with the same
+     * defaults and loader it was added with. Unknown document is just added
+     * with `add()`. Returns result of `add()`.
+     * */
+    bool reindex( const std::string & docID ) {
+        const auto dls = _loading_state_of(docID);
+        drop_document(docID);
+        if( !dls ) return add(docID);
+        const auto & dd = dls->docDefaults;
+        return add( docID
+                  , {true, dd.dataType}
+                  , {true, dd.validityRange}
+                  , {true, dd.baseMD}
+                  , dls->loader
+                  );
+    }
+
+    /**\brief Returns number of index modifications
+     *
+     * Counter is incremented whenever entries are added or removed from the
+     * index (by `add()`, `drop_document()`, `reindex()`, etc). Collections
+     * derived from the index (results of `load()`) shall be considered as
+     * outdated when the counter changes.
+     * */
+    size_t generation() const { return _generation; }
+
+    /// Returns number of index modifications affecting certain data type
+    ///
+    /// Same as `generation()`, but counts only modifications of the
+    /// entries of given type, so collections of other types are not
+    /// invalidated in vain.
+    size_t generation( const aux::Atom & typeName ) const {
+        auto it = _typeGenerations.find(typeName);
+        return it == _typeGenerations.end() ? 0 : it->second;
+    }
+    /// Same as `generation()`, for (not interned) string
+    template<typename S> aux::if_string_like_t<S, size_t>
+    generation( const S & typeName ) const {
+        const auto atom = aux::Atom::find(typeName);
+        return atom ? generation(*atom) : 0;
+    }
+
+    ///\brief Loads calibration data entries, in "overlay mode"
+    ///
+    /// This methood queries indexes for "still valid" data of certain type
+    /// (see `ValidityIndex::updates()`) and performs sequential loading of
+    /// those entries.
+    ///
+    /// Useful for partially-defined data that must be updated incrementally.
+    template<typename T> typename CalibDataTraits<T>::template Collection<>
+    load( KeyT key, bool noTypeIsOk=false, aux::LoadLog * loadLogPtr=nullptr) const {
+        // parsing temporaries of the operation are released at once on exit
+        aux::ArenaScope arenaScope;
+        typename CalibDataTraits<T>::template Collection<> dest;
+        const auto updates = validityIndex.updates(
+                _type_atom<T>(), key, noTypeIsOk );
+        _prefetch(updates);
+        for( const auto & upd : updates ) {
+            load_update_into<T>(upd, dest, key, loadLogPtr);
         }
         return dest;
     }
 
+    ///\brief Loads calibration data entries of multiple types in single pass
+    ///
+    /// Same as single-type `load()`, but for multiple types at once. Updates
+    /// of all the types are grouped by documents, so each document is
+    /// read (mapped, tokenized) only once, with blocks of all requested types
+    /// dispatched to their collections (see `iLoader::read_blocks()`).
+    /// Resulting collections are identical to ones obtained with sequential
+    /// `load<T>()` calls.
+    ///
+    /// Rows of the updates read ahead of their order are buffered with
+    /// the snapshot of metadata in effect. Note that snapshot keeps only
+    /// metadata key/values, without aliases.
+    template<typename T1, typename T2, typename ... Ts>
+    std::tuple< typename CalibDataTraits<T1>::template Collection<>
+              , typename CalibDataTraits<T2>::template Collection<>
+              , typename CalibDataTraits<Ts>::template Collection<>...
+              >
+    load( KeyT key, bool noTypeIsOk=false, aux::LoadLog * loadLogPtr=nullptr) const {
+        aux::ArenaScope arenaScope;
+        std::tuple< typename CalibDataTraits<T1>::template Collection<>
+                  , typename CalibDataTraits<T2>::template Collection<>
+                  , typename CalibDataTraits<Ts>::template Collection<>...
+                  > dests;
+        _load_multiple<T1, T2, Ts...>( dests, key, noTypeIsOk, loadLogPtr
+                                     , std::index_sequence_for<T1, T2, Ts...>() );
+        return dests;
+    }
+
+    ///\brief Loads calibration data entries with statically dispatched loader
+    ///
+    /// Same as `load()`, but documents handled by loader of type `LoaderT`
+    /// are read with statically dispatched parsing routines permitting the
+    /// compiler to inline the whole parsing chain (see
+    /// `load_update_into_static()`). Documents of other loaders (including
+    /// subclasses of `LoaderT`) are read with runtime-polymorphic `iLoader`
+    /// interface.
+    ///
+    ///     auto calibs = docs.load_static<CaloCalibData, sdc::ExtCSVLoader<int>>(5103);
+    template<typename T, typename LoaderT> typename CalibDataTraits<T>::template Collection<>
+    load_static( KeyT key, bool noTypeIsOk=false, aux::LoadLog * loadLogPtr=nullptr) const {
+        aux::ArenaScope arenaScope;
+        typename CalibDataTraits<T>::template Collection<> dest;
+        const auto updates = validityIndex.updates(
+                _type_atom<T>(), key, noTypeIsOk );
+        _prefetch(updates);
+        for( const auto & upd : updates ) {
+            load_update_into_static<T, LoaderT>(upd, dest, key, loadLogPtr);
+        }
+        return dest;
+    }
+
+    /**\brief Updates collection loaded for one key to another key
+     *
+     * Given `dest` collection obtained with `load<T>(oldKey)`, makes it
+     * equal to what `load<T>(newKey)` would return. If no document valid for
+     * `oldKey` expired by `newKey` (see `ValidityIndex::expires()`), only
+     * updates that came into force in between are applied (see
+     * `ValidityIndex::updates(typeName, oldKey, newKey)`), so advancing to
+     * the next key costs nearly nothing when nothing changed. Otherwise (or
+     * if `newKey` precedes `oldKey`, or `oldKey` is unset) collection is
+     * reloaded.
+     *
+     * Index must not be changed since collection was loaded (see
+     * `generation()`).
+     *
+     * Returns `false` if collection was not changed.
+     * */
+    template<typename T> bool
+    advance( typename CalibDataTraits<T>::template Collection<> & dest
+           , KeyT oldKey, KeyT newKey
+           , bool noTypeIsOk=false
+           , aux::LoadLog * loadLogPtr=nullptr
+           ) const {
+        aux::ArenaScope arenaScope;
+        typedef ValidityTraits<KeyT> VT;
+        if( VT::is_set(oldKey) && oldKey == newKey ) return false;
+        if( !VT::is_set(oldKey) || typename VT::Less()(newKey, oldKey)
+         || validityIndex.expires(_type_atom<T>(), oldKey, newKey) ) {
+            dest = load<T>(newKey, noTypeIsOk, loadLogPtr);
+            return true;
+        }
+        const auto updates = validityIndex.updates( _type_atom<T>()
+                                                  , oldKey, newKey, noTypeIsOk );
+        _prefetch(updates);
+        for( const auto & upd : updates ) {
+            load_update_into<T>(upd, dest, newKey, loadLogPtr);
+        }
+        return !updates.empty();
+    }
+
+    /// Piecewise-constant collections over validity keys range
+    ///
+    /// Segments are ordered by keys, each one pairs validity range with the
+    /// collection valid within it (see `load_timeline()`).
+    template<typename T> using Timeline
+        = std::vector< std::pair< ValidityRange<KeyT>
+                                , std::shared_ptr<const typename CalibDataTraits<T>::template Collection<>>
+                                > >;
+
+    /**\brief Loads collections for the whole validity keys range
+     *
+     * Returns piecewise-constant segments covering the keys range, each one
+     * with the collection `load<T>()` would return for any key within the
+     * segment. Segments bounds are the points where set of updates changes
+     * (start or end of document's validity), so for consecutive keys the
+     * work is done only at the change points:
+     *  - each distinct set of updates is collected once;
+     *  - if set of updates is extended with new ones (most common case),
+     *    collection of the previous segment is copied and only new updates
+     *    are applied;
+     *  - rows of the blocks are kept while the block remains in the set of
+     *    updates (for loaders permitting it, see
+     *    `iLoader::cacheable_blocks()`), so each block is read once.
+     *
+     * Range's `from` is inclusive and `to` is exclusive; unset `from` means
+     * "since the first document", unset `to` makes last segment open. Keys
+     * having no updates are not covered by segments.
+     *
+     * Blocks are read for the segment's starting key, so the result is the
+     * same as of `load()` if loader forwards rows regardless of the key
+     * (that is true for loaders with cacheable blocks).
+     *
+     * \throws `sdc::errors::UnknownDataType` if not such data type defined
+     *      (unless `noTypeIsOk` is set).
+     */
+    template<typename T> Timeline<T>
+    load_timeline( const ValidityRange<KeyT> & range
+                 , bool noTypeIsOk=false
+                 , aux::LoadLog * loadLogPtr=nullptr
+                 ) const {
+        aux::ArenaScope arenaScope;
+        typedef typename CalibDataTraits<T>::template Collection<> Collection;
+        typedef ValidityTraits<KeyT> VT;
+        typedef typename ValidityIndex<KeyT, DocumentLoadingState>::DocumentEntry DocumentEntry;
+        Timeline<T> timeline;
+        auto typeIt = validityIndex._types.find(_type_atom<T>());
+        if( validityIndex._types.end() == typeIt ) {
+            if( noTypeIsOk ) return timeline;
+            throw errors::UnknownDataType(CalibDataTraits<T>::typeName);
+        }
+        // collect change points within the range
+        const typename VT::Less less;
+        auto within = [&]( KeyT k ) {
+                return (!VT::is_set(range.from) || !less(k, range.from))
+                    && (!VT::is_set(range.to) || less(k, range.to));
+            };
+        std::set<KeyT, typename VT::Less> bounds;
+        if( VT::is_set(range.from) ) bounds.insert(range.from);
+        for( const auto & p : typeIt->second ) {
+            if( within(p.first) ) bounds.insert(p.first);
+            if( VT::is_set(p.second.validTo) && within(p.second.validTo) )
+                bounds.insert(p.second.validTo);
+        }
+        // rows of the blocks in the current set of updates
+        std::map< const DocumentEntry *
+                , std::shared_ptr<const typename BlockCache::Entry> > rows;
+        std::vector<const DocumentEntry *> prevEntries;
+        for( auto bIt = bounds.begin(); bIt != bounds.end(); ++bIt ) {
+            const KeyT key = *bIt;
+            const KeyT segEnd = std::next(bIt) == bounds.end() ? range.to : *std::next(bIt);
+            const auto updates = validityIndex.updates(_type_atom<T>(), key);
+            std::vector<const DocumentEntry *> entries;
+            for( const auto & upd : updates ) entries.push_back(upd.second);
+            const bool adjacent = !timeline.empty() && timeline.back().first.to == key;
+            if( adjacent && entries == prevEntries ) {
+                timeline.back().first.to = segEnd;  // same updates
+                continue;
+            }
+            if( entries.empty() ) {
+                prevEntries.clear();
+                continue;
+            }
+            // forget rows of blocks that are not in the set anymore
+            const std::set<const DocumentEntry *> current(entries.begin(), entries.end());
+            for( auto it = rows.begin(); it != rows.end(); ) {
+                if( current.count(it->first) ) ++it;
+                else it = rows.erase(it);
+            }
+            // if updates are appended to previous ones, start from copy
+            // of previous collection
+            std::shared_ptr<Collection> dest;
+            size_t nKept = 0;
+            if( adjacent && prevEntries.size() < entries.size()
+             && std::equal(prevEntries.begin(), prevEntries.end(), entries.begin()) ) {
+                dest = std::make_shared<Collection>(*timeline.back().second);
+                nKept = prevEntries.size();
+            } else {
+                dest = std::make_shared<Collection>();
+            }
+            auto updIt = updates.begin();
+            std::advance(updIt, nKept);
+            typename ValidityIndex<KeyT, DocumentLoadingState>::Updates toRead;
+            for( auto it = updIt; it != updates.end(); ++it ) {
+                if( !rows.count(it->second) ) toRead.push_back(*it);
+            }
+            _prefetch(toRead);
+            for( ; updIt != updates.end(); ++updIt ) {
+                const DocumentEntry & de = *updIt->second;
+                auto cllb = [&]( const aux::MetaInfo & meta
+                               , size_t lineNo
+                               , const std::string & expression ) {
+                        if(loadLogPtr) loadLogPtr->set_source(de.docID, lineNo);
+                        _guarded_row(lineNo, expression, de.docID, [&](){
+                            CalibDataTraits<T>::collect( *dest
+                                    , parse_row<T>( expression
+                                          , RowContext{lineNo, de.docID, meta, loadLogPtr} )
+                                    , meta
+                                    , lineNo
+                                    );
+                            });
+                        if(loadLogPtr) loadLogPtr->set_source("(none)", 0);
+                        return true;
+                    };
+                auto rowsIt = rows.find(&de);
+                if( rowsIt != rows.end() ) {
+                    rowsIt->second->replay(cllb);
+                    continue;
+                }
+                iLoader & loader = *de.auxInfo.loader;
+                std::shared_ptr<typename BlockCache::Entry> entry;
+                if( loader.cacheable_blocks() )
+                    entry = std::make_shared<typename BlockCache::Entry>();
+                _with_doc_defaults( de, loader, [&](){
+                        _read_block_cached( de, key, CalibDataTraits<T>::typeName
+                                , [&]( const aux::MetaInfo & meta
+                                     , size_t lineNo
+                                     , const std::string & expression ) {
+                                    if( entry ) entry->add(meta, lineNo, expression);
+                                    return cllb(meta, lineNo, expression);
+                                } );
+                    } );
+                if( entry ) rows.emplace(&de, entry);
+            }
+            prevEntries = std::move(entries);
+            timeline.emplace_back(ValidityRange<KeyT>{key, segEnd}, dest);
+        }
+        return timeline;
+    }
+
+    /**\brief Lazy cursor over the parsed rows of certain type
+     *
+     * Yields rows of the updates for certain validity key in the update
+     * order (same as `load()` would collect them), each parsed with
+     * `CalibDataTraits<T>::parse_line()` on demand. No collection is built,
+     * so it is cheap to scan or filter the data:
+     *
+     *     auto c = docs.rows<CaloCalibData>(5103);
+     *     while(c.next()) {
+     *         if(c.item().channel == 12) { ... break; }
+     *     }
+     *
+     * Range-based `for` loop is supported as well, with the cursor itself
+     * being the element:
+     *
+     *     for(const auto & row : docs.rows<CaloCalibData>(5103)) {
+     *         std::cout << row.doc_id() << ":" << row.line_number() ...
+     *     }
+     *
+     * Cursor refers to `Documents` instance, so it must not outlive it.
+     */
+    template<typename T>
+    class RowCursor {
+    private:
+        const Documents<KeyT> * _docs;
+        KeyT _key;
+        aux::LoadLog * _loadLogPtr;
+        /// Updates to iterate over
+        std::vector<Update> _updates;
+        /// Number of current update
+        size_t _nUpd;
+        /// Cursor over current update's block
+        std::unique_ptr<typename iLoader::iRowCursor> _cursor;
+        /// Current item
+        std::optional<T> _item;
+        /// Whether `next()` was called at least once
+        bool _started;
+    public:
+        RowCursor( const Documents<KeyT> & docs
+                 , KeyT key
+                 , const typename ValidityIndex<KeyT, DocumentLoadingState>::Updates & upds
+                 , aux::LoadLog * loadLogPtr
+                 ) : _docs(&docs)
+                   , _key(key)
+                   , _loadLogPtr(loadLogPtr)
+                   , _updates(upds.begin(), upds.end())
+                   , _nUpd(0)
+                   , _started(false)
+                   {}
+
+        /// Advances to the next row; returns `false` when rows are exhausted
+        bool next() {
+            _started = true;
+            aux::ArenaScope arenaScope;
+            while( _nUpd < _updates.size() ) {
+                const auto & de = *_updates[_nUpd].second;
+                if( !_cursor ) {
+                    _cursor = _docs->_open_block_cursor( de, _key
+                                        , CalibDataTraits<T>::typeName );
+                }
+                if( _docs->_cursor_next(*_cursor, de.docID) ) {
+                    const auto & meta = _cursor->metainfo();
+                    const std::string & expression = _cursor->expression();
+                    const size_t lineNo = _cursor->line_number();
+                    if(_loadLogPtr) _loadLogPtr->set_source(de.docID, lineNo);
+                    _guarded_row(lineNo, expression, de.docID, [&](){
+                            _item.emplace( parse_row<T>( expression
+                                    , RowContext{lineNo, de.docID, meta, _loadLogPtr} ) );
+                        });
+                    if(_loadLogPtr) _loadLogPtr->set_source("(none)", 0);
+                    return true;
+                }
+                _cursor.reset();
+                ++_nUpd;
+            }
+            _item.reset();
+            return false;
+        }
+
+        /// Current parsed item
+        const T & item() const { return *_item; }
+        /// Document ID of current item
+        const std::string & doc_id() const { return _updates[_nUpd].second->docID; }
+        /// Line number of current item
+        size_t line_number() const { return _cursor->line_number(); }
+        /// Metadata in effect for current item
+        const aux::MetaInfo & metainfo() const { return _cursor->metainfo(); }
+
+        /// Input iterator for range-based loops
+        class iterator {
+        private:
+            RowCursor * _c;
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef RowCursor value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const RowCursor * pointer;
+            typedef const RowCursor & reference;
+
+            iterator(RowCursor * c) : _c(c) {}
+            reference operator*() const { return *_c; }
+            pointer operator->() const { return _c; }
+            iterator & operator++() {
+                if( !_c->next() ) _c = nullptr;
+                return *this;
+            }
+            bool operator==(const iterator & o) const { return _c == o._c; }
+            bool operator!=(const iterator & o) const { return _c != o._c; }
+        };
+        ///\brief Returns iterator to current row
+        ///
+        /// Fetches first row if cursor was not advanced yet, so repeated
+        /// calls do not skip rows.
+        iterator begin() {
+            if( !_started ) next();
+            return iterator(_item ? this : nullptr);
+        }
+        /// Sentinel iterator
+        iterator end() { return iterator(nullptr); }
+    };
+
+    ///\brief Returns lazy cursor over the rows of certain type
+    ///
+    /// Queries updates in the same way as `load()` does, but instead of
+    /// collecting the data returns cursor parsing rows on demand (see
+    /// `RowCursor`).
+    template<typename T> RowCursor<T>
+    rows( KeyT key, bool noTypeIsOk=false, aux::LoadLog * loadLogPtr=nullptr) const {
+        return RowCursor<T>( *this, key
+                , validityIndex.updates(_type_atom<T>(), key, noTypeIsOk)
+                , loadLogPtr );
+    }
+
     ///\brief Loads "most recent" calibration data entry
     ///
     /// This methood queries indexes for "most recent" data of certain type
@@ -2565,7 +6605,7 @@ public:
     template<typename T> typename CalibDataTraits<T>::template Collection<>
     get_latest(KeyT key, aux::LoadLog * loadLogPtr=nullptr) const {
         typename CalibDataTraits<T>::template Collection<> dest;
-        load_update_into<T>( validityIndex.latest(CalibDataTraits<T>::typeName, key)
+        load_update_into<T>( validityIndex.latest(_type_atom<T>(), key)
                             , dest
                             , key
                             , loadLogPtr );
@@ -2662,7 +6702,7 @@ template<typename T>
 struct SrcInfo {
     T data;
     size_t lineNo;
-    std::string srcDocID;
+    aux::Atom srcDocID;
 };
 
 /**\brief A traits for type containing also the filename that provided
@@ -2695,25 +6735,132 @@ struct CalibDataTraits< SrcInfo<T> > {
     }
     /// Forwards call to wrapped traits
     static SrcInfo<T>
+    parse_line( const std::string & line
+              , const RowContext & ctx
+              ) {
+        assert(ctx.docID == ctx.md.get<std::string>("@docID", ctx.docID));
+        assert(ctx.lineNo == ctx.md.get<size_t>("@lineNo", ctx.lineNo));
+        return SrcInfo<T>{
+                  parse_row<T>(line, ctx)
+                , ctx.lineNo
+                , ctx.docID
+                };
+    }
+    /// Forwards call to wrapped traits (legacy signature)
+    static SrcInfo<T>
     parse_line( const std::string & line
               , size_t lineNo
               , const aux::MetaInfo & mi
               , const std::string & filename
               , aux::LoadLog * loadLogPtr=nullptr
               ) {
-        assert(mi.get<size_t>("@lineNo") == lineNo);
-        assert(filename == mi.get<std::string>("@docID", "(undefined)"));
-        return SrcInfo<T>{
-                  CalibDataTraits<T>::parse_line(line, lineNo, mi, filename)
-                , lineNo
-                , filename
-                };
+        return parse_line(line, RowContext{lineNo, filename, mi, loadLogPtr});
     }
 };
 
 //                                                                     ________
 // __________________________________________________________________/ Loaders
 
+///\brief Run-time grammar of "extended CSV" documents
+///
+/// Default grammar policy of `ExtCSVLoader`: special characters and tags
+/// may be changed at run time (by `ExtCSVLoader::grammar`), at a cost of
+/// checking them on every line. Null character disables comments or
+/// metadata; empty tag disables respective metadata treatment.
+///
+/// \ingroup utils
+struct ExtCSVGrammar {
+    char commentChar = '#'
+       , metadataMarker = '=';
+    std::string metadataKeyTag = "runs"
+              , metadataTypeTag = "type"
+              ;
+};
+
+/**\brief Compile-time grammar of "extended CSV" documents
+ *
+ * Grammar policy for `ExtCSVLoader` with default dialect, fixed at compile
+ * time. Defined as static constants, special characters and tags let the
+ * compiler specialize the parsing routines: disabled features and checks of
+ * the characters are eliminated, and tags are compared as fixed-length
+ * strings. Other dialects may be defined by hiding the constants in
+ * subclass:
+ *
+ *      struct MyGrammar : public sdc::StaticExtCSVGrammar {
+ *          static constexpr char commentChar = ';';
+ *          static constexpr std::string_view metadataKeyTag = "validity";
+ *      };
+ *      sdc::ExtCSVLoader<int, MyGrammar> loader;
+ *
+ * \ingroup utils
+ * */
+struct StaticExtCSVGrammar {
+    static constexpr char commentChar = '#'
+                        , metadataMarker = '=';
+    static constexpr std::string_view metadataKeyTag = "runs"
+                                    , metadataTypeTag = "type"
+                                    ;
+};
+
+/**\brief Uniform access to the grammar of `ExtCSVLoader`
+ *
+ * Generic definition is for run-time grammar (like `ExtCSVGrammar`); the
+ * specialization below is chosen for grammars defining characters as
+ * static constants (like `StaticExtCSVGrammar`).
+ *
+ * \ingroup type-traits
+ * */
+template< typename GrammarT
+        , bool=std::is_member_object_pointer<decltype(&GrammarT::commentChar)>::value
+        >
+struct ExtCSVGrammarTraits {
+    /// Set for compile-time grammar
+    static constexpr bool isStatic = false;
+    /// Returns character starting comment, `\0` if comments are disabled
+    static char comment_char(const GrammarT & g) { return g.commentChar; }
+    /// Returns metadata key/value delimiter, `\0` if metadata is disabled
+    static char metadata_marker(const GrammarT & g) { return g.metadataMarker; }
+    /// Returns whether metadata key is the validity range tag
+    static bool is_key_tag(const GrammarT & g, std::string_view key) {
+        return (!g.metadataKeyTag.empty()) && key == g.metadataKeyTag;
+    }
+    /// Returns whether metadata key is the data type tag
+    static bool is_type_tag(const GrammarT & g, std::string_view key) {
+        return (!g.metadataTypeTag.empty()) && key == g.metadataTypeTag;
+    }
+    /// Returns validity range tag
+    static std::string key_tag(const GrammarT & g) { return g.metadataKeyTag; }
+    /// Returns data type tag
+    static std::string type_tag(const GrammarT & g) { return g.metadataTypeTag; }
+};
+
+/// Specialization for compile-time grammar
+template<typename GrammarT>
+struct ExtCSVGrammarTraits<GrammarT, false> {
+    static constexpr bool isStatic = true;
+    static constexpr char comment_char(const GrammarT &) { return GrammarT::commentChar; }
+    static constexpr char metadata_marker(const GrammarT &) { return GrammarT::metadataMarker; }
+    static bool is_key_tag(const GrammarT &, std::string_view key) {
+        return _matches<GrammarT::metadataKeyTag.size()>(key, GrammarT::metadataKeyTag.data());
+    }
+    static bool is_type_tag(const GrammarT &, std::string_view key) {
+        return _matches<GrammarT::metadataTypeTag.size()>(key, GrammarT::metadataTypeTag.data());
+    }
+    static std::string key_tag(const GrammarT &) {
+        return std::string(GrammarT::metadataKeyTag);
+    }
+    static std::string type_tag(const GrammarT &) {
+        return std::string(GrammarT::metadataTypeTag);
+    }
+private:
+    /// Fixed-length comparison; empty tag never matches
+    template<size_t N> static bool
+    _matches(std::string_view key, const char * tag) {
+        if constexpr (0 == N) return false;
+        else return key.size() == N && 0 == std::memcmp(key.data(), tag, N);
+    }
+};
+
 /**\brief An extended CSV data file format stream-based loader
  *
  * This loader uses ASCII stream to load the data in structures. The grammar
@@ -2753,32 +6900,38 @@ struct CalibDataTraits< SrcInfo<T> > {
  * block inherits values from above, meaning that `key1` and `key2` will be
  * defined for both block#1 and block#2.
  *
+ * Grammar is defined by the policy type: default `ExtCSVGrammar` is
+ * customizable at run time, while for documents of fixed dialect a
+ * compile-time grammar (like `StaticExtCSVGrammar`) yields faster parser.
+ *
  * \ingroup utils
  * */
-template<typename KeyT>
+template<typename KeyT, typename GrammarT=ExtCSVGrammar>
 class ExtCSVLoader : public Documents<KeyT>::iLoader {
 public:
     /// Alias for current validity traits
     typedef ValidityTraits<KeyT> VT;
+    /// Grammar type
+    typedef GrammarT Grammar;
+    /// Access traits of the grammar
+    typedef ExtCSVGrammarTraits<GrammarT> GT;
 
-    /// A grammar, available for public changes
-    struct Grammar {
-        char commentChar
-           , metadataMarker;
-        std::string metadataKeyTag
-                  , metadataTypeTag
-                  ;
-    } grammar;
+    /// A grammar, available for public changes (if defined at run time)
+    Grammar grammar;
 
     /// Interface structure of reentrant state used to parse the CSV document
     struct iState {
+        /// Byte offset of the line being currently handled (set by parser)
+        size_t lineOffset;
+
+        iState() : lineOffset(0) {}
         /// Returns position of comment's start/stop
-        virtual std::pair<size_t, size_t> handle_comment( const std::string & line ) = 0;
+        virtual std::pair<size_t, size_t> handle_comment( std::string_view line ) = 0;
         /// Shall try to treat the given line as metadata and return whether it
         /// is a line with metadata
-        virtual uint32_t handle_metadata( const std::string & line, size_t lineNo ) = 0;
+        virtual uint32_t handle_metadata( std::string_view line, size_t lineNo ) = 0;
         /// Handles CSV line
-        virtual bool handle_csv(const std::string & line, size_t lineNo) = 0;
+        virtual bool handle_csv(std::string_view line, size_t lineNo) = 0;
         /// Handles CSV block start
         virtual void handle_csv_start(size_t lineNo) = 0;
     };
@@ -2786,9 +6939,9 @@ public:
     /// Basic implementation of the comment locating function, compatible with
     /// `aux::getline()`; commonly used by `iState` subclasses
     static std::pair<size_t, size_t>
-    locate_comment_char( char c, const std::string & line ) {
+    locate_comment_char( char c, std::string_view line ) {
         if( '\0' == c ) return { std::string::npos, std::string::npos };
-        return { line.find(c)
+        return { aux::simd::find(line, c)
                , std::string::npos
                };
     }
@@ -2806,56 +6959,69 @@ public:
         std::string type;
         /// Resulting document structure
         std::list<typename Documents<KeyT>::DataBlock> r;
+        /// Metadata defined so far, only latest value of each entry
+        aux::MetaInfo md;
+        /// Last metadata snapshot taken; reset when metadata changes
+        std::shared_ptr<const aux::MetaInfo> mdSnapshot;
 
         PreparsingState( const Grammar & g_
                        , const ValidityRange<KeyT> & validity_
                        , const std::string & type_
+                       , const aux::MetaInfo & baseMD
                        ) : g(g_)
                          , validity(validity_)
                          , type(type_)
+                         , md(baseMD)
                          {}
 
         /// Treats basic single-char comment syntax
-        std::pair<size_t, size_t> handle_comment( const std::string & line ) override {
-            return locate_comment_char(g.commentChar, line);
+        std::pair<size_t, size_t> handle_comment( std::string_view line ) override {
+            return locate_comment_char(GT::comment_char(g), line);
         }
-        /// We currently look only for validity key and data type metadata,
-        /// if provided by current grammar settings or defaults
-        uint32_t handle_metadata( const std::string & line, size_t lineNo ) override {
+        /// Collects metadata for snapshots and looks up for validity key and
+        /// data type metadata, if provided by current grammar settings or
+        /// defaults
+        uint32_t handle_metadata( std::string_view line, size_t lineNo ) override {
             uint32_t rCode = 0x0;
-            if( '\0' == g.metadataMarker ) return rCode;
-            auto eqP = line.find( g.metadataMarker );
+            if( '\0' == GT::metadata_marker(g) ) return rCode;
+            auto eqP = aux::simd::find( line, GT::metadata_marker(g) );
             if( eqP == std::string::npos ) return rCode;
-            const std::string key = aux::trim(line.substr(0, eqP));
+            const std::string_view key = aux::trim_view(line.substr(0, eqP));
             
             rCode |= 0x1;
-            if( (!g.metadataKeyTag.empty())
-             && key == g.metadataKeyTag ) {
+            // superseded value is not needed by the blocks below, so
+            // snapshots size is bound by the number of distinct entries
+            const std::string_view name = md.resolve_alias_view(key);
+            md.drop(name);
+            md.set( name, aux::trim_view(line.substr(eqP + 1)), lineNo );
+            mdSnapshot.reset();
+            if( GT::is_key_tag(g, key) ) {
                 validity
                     = aux::LexicalTraits< ValidityRange<KeyT> >
-                         ::from_string( line.substr(eqP + 1));
+                         ::from_string(std::string(line.substr(eqP + 1)));
                 rCode |= 0x2;
             }
-            if( (!g.metadataTypeTag.empty())
-                    && key == g.metadataTypeTag ) {
-                type = aux::trim(line.substr(eqP + 1));
+            if( GT::is_type_tag(g, key) ) {
+                type = aux::trim_view(line.substr(eqP + 1));
                 rCode |= 0x2;
             }
             return rCode;
         }
         /// Does nothing
-        bool handle_csv(const std::string &, size_t) override { return true; }
+        bool handle_csv(std::string_view, size_t) override { return true; }
         /// Appends CSV block start marking
         void handle_csv_start(size_t lineNo) override {
             // TODO: handle defaults
             // Assure the data type / validity range are set (or
             // take defaults)
-            typename Documents<KeyT>::DataBlock db {type, validity, lineNo};
+            if( !mdSnapshot ) mdSnapshot = std::make_shared<const aux::MetaInfo>(md);
+            typename Documents<KeyT>::DataBlock db { type, validity, lineNo
+                                                   , this->lineOffset, mdSnapshot };
             if( db.dataType.empty() ) {
                 db.dataType = type;
             }
             if( db.dataType.empty() ) {
-                throw errors::NoDataTypeDefined( g.metadataTypeTag
+                throw errors::NoDataTypeDefined( GT::type_tag(g)
                                                , lineNo );
             }
             if(!( ValidityTraits<KeyT>::is_set(db.validityRange.from)
@@ -2866,15 +7032,20 @@ public:
             if(!( ValidityTraits<KeyT>::is_set(db.validityRange.from)
                || ValidityTraits<KeyT>::is_set(db.validityRange.to)
                ) ) {
-                throw errors::NoValidityRange( g.metadataTypeTag
+                throw errors::NoValidityRange( GT::type_tag(g)
                                              , lineNo );
             }
             r.push_back(db);
         }
     };  // PreparsingState
 
-    /// Reentrant state used for pre-parsing, default simple grammar handling
-    struct ParsingState : public iState {
+    /// Reentrant state used for parsing, default simple grammar handling
+    ///
+    /// Parameterised with callback type. Callback may accept line as
+    /// `std::string_view` (then line is not copied), otherwise
+    /// `std::string` is constructed.
+    template<typename CallbackT>
+    struct BasicParsingState : public iState {
         /// Currently used "ExtCSV" grammar
         const Grammar & g;
         /// A validity range for current CSV block
@@ -2886,18 +7057,18 @@ public:
         /// Validity key of interest
         const KeyT forKey;
         /// CSV data parsing callback
-        typename Documents<KeyT>::iLoader::ReaderCallback cllb;
+        CallbackT cllb;
         /// Current metadata storage
         aux::MetaInfo md;
 
-        ParsingState( Grammar & g_
-                    , const ValidityRange<KeyT> & cVal_
-                    , const std::string & cType_
-                    , const std::string & forType_
-                    , const KeyT forKey_
-                    , typename Documents<KeyT>::iLoader::ReaderCallback cllb_
-                    , const aux::MetaInfo baseMD
-                    ) : g(g_)
+        BasicParsingState( Grammar & g_
+                         , const ValidityRange<KeyT> & cVal_
+                         , const std::string & cType_
+                         , const std::string & forType_
+                         , const KeyT forKey_
+                         , CallbackT cllb_
+                         , const aux::MetaInfo baseMD
+                         ) : g(g_)
                       , cVal(cVal_)
                       , cType(cType_)
                       , forType(forType_)
@@ -2907,73 +7078,211 @@ public:
                       {}
 
         /// Treats basic single-char comment syntax
-        std::pair<size_t, size_t> handle_comment( const std::string & line ) override {
-            return locate_comment_char(g.commentChar, line);
+        std::pair<size_t, size_t> handle_comment( std::string_view line ) override {
+            return locate_comment_char(GT::comment_char(g), line);
         }
 
         /// Full support for the metadata
-        uint32_t handle_metadata( const std::string & line, size_t lineNo ) override {
+        uint32_t handle_metadata( std::string_view line, size_t lineNo ) override {
             uint32_t r = 0x0;
-            if( '\0' == g.metadataMarker ) return r;
-            auto eqP = line.find( g.metadataMarker );
+            if( '\0' == GT::metadata_marker(g) ) return r;
+            auto eqP = aux::simd::find( line, GT::metadata_marker(g) );
             if( eqP == std::string::npos ) return r;
-            const std::string key = aux::trim( line.substr(0, eqP) )
-                            , val = aux::trim( line.substr(eqP + 1) )
-                            ;
+            // key and value refer to the line, only stored value is copied
+            const std::string_view key = aux::trim_view(line.substr(0, eqP))
+                                 , val = aux::trim_view(line.substr(eqP + 1))
+                                 ;
             md.set( key, val, lineNo );
             r |= 0x1;
-            if( (!g.metadataKeyTag.empty())
-             && g.metadataKeyTag == key ) {
+            if( GT::is_key_tag(g, key) ) {
                 cVal = aux::LexicalTraits< ValidityRange<KeyT> >
-                        ::from_string(val);
+                        ::from_string(std::string(val));
                 r |= 0x2;
             }
-            if( (!g.metadataTypeTag.empty())
-             && g.metadataTypeTag == key ) {
-                cType = val;
+            if( GT::is_type_tag(g, key) ) {
+                cType.assign(val.data(), val.size());
                 r |= 0x2;
             }
             return r;
         }
         /// Forwards execution to data parsing callable for the range that must
         /// be read
-        bool handle_csv(const std::string & line, size_t lineNo) override {
+        bool handle_csv(std::string_view line, size_t lineNo) override {
+            if( !accepts_csv() ) return true;
+            // provides `@lineNo` to callback, without modifying entries
+            md.set_row_line(lineNo);
+            bool ret;
+            if constexpr (std::is_invocable_v< CallbackT &, const aux::MetaInfo &
+                                             , size_t, std::string_view>) {
+                ret = cllb(md, lineNo, line);
+            } else {
+                ret = cllb(md, lineNo, std::string(line));
+            }
+            md.set_row_line(aux::MetaInfo::noRow);
+            return ret;
+        }
+        /// Does nothing
+        void handle_csv_start(size_t lineNo) override {}
+        /// Returns whether current CSV block is of type and validity
+        /// of interest
+        bool accepts_csv() const {
             assert((bool) cVal);
             assert(!cType.empty());
-            if( cType != forType ) return true;  // other type
+            if( cType != forType ) return false;  // other type
             if( ValidityTraits<KeyT>::is_set(cVal.from)
-              && forKey < cVal.from ) return true;  // not valid yet
+              && forKey < cVal.from ) return false;  // not valid yet
             if( ValidityTraits<KeyT>::is_set(cVal.to)
-              && (cVal.to < forKey || cVal.to == forKey ) ) return true;  // not valid already
-            char bf[32];
-            snprintf(bf, sizeof(bf), "%zu", lineNo);
-            md.set("@lineNo", bf);
-            assert(md.get<size_t>("@lineNo") == lineNo);
-            bool ret = cllb(md, lineNo, line);
-            assert(md.get<size_t>("@lineNo") == lineNo);
-            md.drop("@lineNo");
-            return ret;
+              && (cVal.to < forKey || cVal.to == forKey ) ) return false;  // not valid already
+            return true;
         }
-        /// Does nothing
-        void handle_csv_start(size_t lineNo) override {}
-    };  // struct ParsingState
+    };  // struct BasicParsingState
+
+    /// Parsing state forwarding rows to polymorphic callback
+    typedef BasicParsingState<typename Documents<KeyT>::iLoader::ReaderCallback>
+            ParsingState;
+
+    /// Parsing state used for statically dispatched reading
+    ///
+    /// Being final, permits compiler to resolve (and inline) state's
+    /// handlers invoked by templated parsing routines.
+    template<typename CallbackT>
+    struct StaticParsingState final : public BasicParsingState<CallbackT> {
+        using BasicParsingState<CallbackT>::BasicParsingState;
+    };
+
+    /// Seals the state type used by loader's own parsing routines
+    ///
+    /// Handlers of `iState` invoked by templated parsing routines on the
+    /// final type get resolved at compile time instead of virtual calls.
+    template<typename StateT>
+    struct Sealed final : public StateT {
+        using StateT::StateT;
+    };
+
+    /// Parsing state used by row cursor
+    ///
+    /// Instead of forwarding the CSV line to callback, keeps it till the
+    /// next line is requested.
+    struct CursorState : public ParsingState {
+        /// Content of the current row
+        std::string expression;
+        /// Line number of the current row
+        size_t lineNo;
+        /// Set when row is retrieved
+        bool hasRow;
+
+        CursorState( Grammar & g_
+                   , const ValidityRange<KeyT> & cVal_
+                   , const std::string & cType_
+                   , const std::string & forType_
+                   , const KeyT forKey_
+                   , const aux::MetaInfo baseMD
+                   ) : ParsingState( g_, cVal_, cType_, forType_, forKey_
+                                   , nullptr, baseMD )
+                     , lineNo(0)
+                     , hasRow(false)
+                     {}
+
+        bool handle_csv(std::string_view line, size_t lineNo_) override {
+            if( !this->accepts_csv() ) return true;
+            expression.assign(line.data(), line.size());
+            lineNo = lineNo_;
+            this->md.set_row_line(lineNo_);
+            hasRow = true;
+            return true;
+        }
+    };
+
+    /// Position of lines scanning within the document
+    struct LineScan {
+        std::string scratch;
+        bool indexNextCSVLine;
+        bool thisBlockPassed;
+        /// Set when scanning is over (end of document or block)
+        bool finished;
+        /// Number of last line scanned
+        size_t lastLine;
+
+        LineScan() : indexNextCSVLine(true)
+                   , thisBlockPassed(false)
+                   , finished(false)
+                   , lastLine(0)
+                   {}
+    };
+
+    /// Row cursor implementation, reading block of mapped document
+    class BlockCursor : public Documents<KeyT>::iLoader::iRowCursor {
+    private:
+        ExtCSVLoader & _loader;
+        aux::MappedDocument _doc;
+        const std::string _forType;
+        aux::LineReader _reader;
+        Sealed<CursorState> _state;
+        LineScan _scan;
+        const IntradocMarkup_t _blockBgn;
+    public:
+        BlockCursor( ExtCSVLoader & loader
+                   , const std::string & docID
+                   , KeyT k
+                   , const std::string & forType
+                   , const typename Documents<KeyT>::DataBlock & block
+                   ) : _loader(loader)
+                     , _doc(docID, _restart_point(block))
+                     , _forType(forType)
+                     , _reader(_doc.content(), 0, 0, _doc.base_offset())
+                     , _state( loader.grammar
+                             , loader._block_start(block).validity
+                             , loader._block_start(block).type
+                             , _forType
+                             , k
+                             , loader._block_start(block).md
+                             )
+                     , _blockBgn(block.blockBgn)
+                     {
+            if( !_state.md.has("@docID") )
+                _state.md.set( "@docID", docID, std::numeric_limits<size_t>::min() );
+            loader._seek_block(_reader, block);
+        }
+
+        bool next() override {
+            _state.hasRow = false;
+            _state.md.set_row_line(aux::MetaInfo::noRow);
+            while( !_state.hasRow
+                && _loader._next_csv_line( _reader, _state, _scan
+                                         , _blockBgn, ENABLE_SDC_FIX001 ) ) {}
+            return _state.hasRow;
+        }
+        const aux::MetaInfo & metainfo() const override { return _state.md; }
+        size_t line_number() const override { return _state.lineNo; }
+        const std::string & expression() const override { return _state.expression; }
+    };
 protected:
-    /// Aux function iterating over CSV/SDC lines in stream
-    size_t _parse_stream( std::istream & inputStream
-                        , iState & state
-                        , IntradocMarkup_t acceptCSVFromLine
-                        , bool onlyThisBlock=false
-                        ) {
+    /// Aux function scanning lines of in-memory document till next CSV line
+    /// is handled by the state
+    ///
+    /// Returns `false` if end of the document (or of the block, if
+    /// `onlyThisBlock` is set) is reached.
+    template<typename StateT>
+    bool _next_csv_line( aux::LineReader & reader
+                       , StateT & state
+                       , LineScan & scan
+                       , IntradocMarkup_t acceptCSVFromLine
+                       , bool onlyThisBlock=false
+                       ) {
         // This is the most important method of (pre-)parsing the documents;
         // it steers the logic of indexing CSV blocks wrt document structure.
-        std::string line;
-        size_t lineCount = 0;
-        bool indexNextCSVLine = true;
-        bool thisBlockPassed = false;
-        // read next line:
-        while( aux::getline( inputStream, line, lineCount
-                    , [&](const std::string & l){return state.handle_comment(l);}
-                    ) ) {
+        if( scan.finished ) return false;
+        std::string_view line;
+        size_t lineOffset;
+        bool & indexNextCSVLine = scan.indexNextCSVLine;
+        // read next line, keeping track on the byte offset:
+        while( reader.next(line, lineOffset) ) {
+            const size_t lineCount = scan.lastLine = reader.line_number();
+            state.lineOffset = lineOffset;
+            aux::strip_line_view( line, scan.scratch
+                    , [&](std::string_view l){return state.handle_comment(l);}
+                    );
+            if( line.empty() ) continue;
             // by default we assume new line being read to be metadata
             // expression, `handle_metadata()` accepts line and should test it
             // against "is metadata" condition. If the result of metadata
@@ -2987,9 +7296,12 @@ protected:
                 continue;
             }
             if(lineCount < acceptCSVFromLine) continue;  // omit irrelevant CSV
-            if(indexNextCSVLine && onlyThisBlock) {
-                if(thisBlockPassed) return lineCount;
-                thisBlockPassed = true;
+            if(indexNextCSVLine && onlyThisBlock && acceptCSVFromLine) {
+                if(scan.thisBlockPassed) {
+                    scan.finished = true;
+                    return false;
+                }
+                scan.thisBlockPassed = true;
             }
             if( ! state.handle_csv(line, lineCount) ) {
                 continue;  // not a CSV
@@ -3001,12 +7313,152 @@ protected:
                 state.handle_csv_start(lineCount);
                 indexNextCSVLine = false;
             }
+            return true;
+        }
+        scan.finished = true;
+        return false;
+    }
+
+    /// Aux function iterating over CSV/SDC lines of in-memory document
+    ///
+    /// Reader must be positioned at the line start (beginning of the
+    /// document by default). Returns number of the last line read.
+    template<typename StateT>
+    size_t _parse_lines( aux::LineReader & reader
+                       , StateT & state
+                       , IntradocMarkup_t acceptCSVFromLine
+                       , bool onlyThisBlock=false
+                       ) {
+        LineScan scan;
+        while( _next_csv_line(reader, state, scan, acceptCSVFromLine, onlyThisBlock) ) {}
+        return scan.lastLine;
+    }
+
+    /// Retrieves document structure from in-memory content
+    std::list<typename Documents<KeyT>::DataBlock>
+    _get_doc_struct( std::string_view content ) {
+        Sealed<PreparsingState> state( grammar
+                                     , this->defaults.validityRange
+                                     , this->defaults.dataType
+                                     , this->defaults.baseMD
+                                     );
+        aux::LineReader reader(content);
+        _parse_lines( reader, state, 0 );
+        return state.r;
+    }
+
+    /// Reads data from in-memory content sequentially
+    void _read_data( std::string_view content
+                   , KeyT k
+                   , const std::string & forType
+                   , IntradocMarkup_t acceptCSVFromLine
+                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                   ) {
+        Sealed<ParsingState> state( grammar
+                                  , this->defaults.validityRange
+                                  , this->defaults.dataType
+                                  , forType
+                                  , k
+                                  , cllb
+                                  , this->defaults.baseMD
+                                  );
+        aux::LineReader reader(content);
+        _parse_lines( reader, state, acceptCSVFromLine, ENABLE_SDC_FIX001 );
+    }
+
+    /// Reads single data block from in-memory content, using positional
+    /// markup, if available
+    ///
+    /// Content may start at `base` offset of the document if block has
+    /// positional markup.
+    void _read_block( std::string_view content
+                    , KeyT k
+                    , const std::string & forType
+                    , const typename Documents<KeyT>::DataBlock & block
+                    , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                    , size_t base=0
+                    ) {
+        if( ! block.mdSnapshot ) {
+            _read_data( content, k, forType, block.blockBgn, cllb );
+            return;
+        }
+        Sealed<ParsingState> state( grammar
+                                  , block.validityRange
+                                  , block.dataType
+                                  , forType
+                                  , k
+                                  , cllb
+                                  , *block.mdSnapshot
+                                  );
+        aux::LineReader reader(content, 0, 0, base);
+        _seek_block(reader, block);
+        _parse_lines( reader, state, block.blockBgn, ENABLE_SDC_FIX001 );
+    }
+
+    /// Parsing state initials for the block reading
+    struct BlockStart {
+        const ValidityRange<KeyT> & validity;
+        const std::string & type;
+        const aux::MetaInfo & md;
+    };
+
+    /// Returns parsing state initials for the block: ones captured at
+    /// pre-parsing, if available, or loader's defaults otherwise (then
+    /// document shall be read from the beginning)
+    BlockStart _block_start( const typename Documents<KeyT>::DataBlock & block ) const {
+        if( block.mdSnapshot )
+            return BlockStart{ block.validityRange, block.dataType, *block.mdSnapshot };
+        return BlockStart{ this->defaults.validityRange
+                         , this->defaults.dataType
+                         , this->defaults.baseMD
+                         };
+    }
+
+    /// Positions reader at the block start, if block has positional markup
+    ///
+    /// Otherwise reader is left at the document start.
+    void _seek_block( aux::LineReader & reader
+                    , const typename Documents<KeyT>::DataBlock & block
+                    ) {
+        if( block.mdSnapshot ) reader.seek(block.blockOffset, block.blockBgn - 1);
+    }
+
+    /// Returns whether document name suggests it is compressed
+    static bool _compressed_name( const std::string & docID ) {
+        for( const char * sfx : {".gz", ".xz", ".zst"} ) {
+            const size_t n = strlen(sfx);
+            if( docID.size() > n && 0 == docID.compare(docID.size() - n, n, sfx) )
+                return true;
         }
-        return lineCount;
+        return false;
+    }
+
+    /// Returns decompressor restart point to read the block from, if any
+    static const aux::RestartPoint *
+    _restart_point( const typename Documents<KeyT>::DataBlock & block ) {
+        return block.mdSnapshot ? block.restartPoint.get() : nullptr;
     }
 public:  // iLoader interface implementation
+    ///\brief Maximum distance between decompressor restart points, bytes
+    ///
+    /// For compressed documents, restart points are collected at
+    /// pre-parsing and assigned to blocks, so that reading a block requires
+    /// decompression of the document starting from the nearest point
+    /// preceding the block. Smaller values imply more memory to keep the
+    /// points (about 32 kB each). Zero disables restart points.
+    size_t restartPointsSpan;
+    ///\brief Span of the document prefetched for a block, bytes
+    ///
+    /// Blocks extent is not known from the document structure, so this much
+    /// of the document is requested to be read ahead from the block's start
+    /// (see `prefetch()`). Zero means the rest of the document.
+    size_t prefetchSpan;
+
     /// Initializes default grammar
-    ExtCSVLoader() : grammar{ '#', '=', "runs", "type" } {}
+    ExtCSVLoader() : grammar()
+                   , restartPointsSpan(1024*1024)
+                   , prefetchSpan(4*1024*1024)
+                   {}
 
     /**\brief Preliminary parses of SDC file retrieving only basic info
      *
@@ -3014,40 +7466,45 @@ public:  // iLoader interface implementation
      * metadata blocks. Returns basic document structure for further usage.
      *
      * Permits for blocks having no data type and/or validity range.
+     *
+     * Stream content is read in memory starting from the current position;
+     * recorded byte offsets are relative to this position.
      * */
     std::list<typename Documents<KeyT>::DataBlock> 
             get_doc_struct( std::istream & ifs ) {
-        PreparsingState state( grammar
-                             , this->defaults.validityRange
-                             , this->defaults.dataType
-                             );
-        _parse_stream( ifs, state, 0 );
-        return state.r;
+        const std::string content( (std::istreambuf_iterator<char>(ifs))
+                                 , std::istreambuf_iterator<char>() );
+        return _get_doc_struct(content);
     }
 
-    /**\brief Opens file and forwards parsing to stream version.
+    /**\brief Maps the file and retrieves document structure
      *
      * Opens the file (currently, only supports local files), and retrieves
      * only the document structure to add the principal metadata in index
      * (data type and the validity range).
      *
+     * Compressed documents are decompressed entirely; restart points
+     * collected meanwhile are assigned to the blocks.
+     *
      * \todo Support for remote location, user-defined access, etc.
      */
     std::list<typename Documents<KeyT>::DataBlock>
                 get_doc_struct( const std::string & docID) override {
-        // open file (closed by its destructor at exit)
-        std::ifstream ifs(docID, std::ios::in);
-        if(!ifs.good()) {
-            throw errors::IOError(docID, "could not create input stream");
-        }
+        aux::MappedDocument doc(docID, nullptr, restartPointsSpan);
         this->defaults.baseMD.set( "@docID"
                                  , docID
                                  , std::numeric_limits<size_t>::min()
                                  );
-        auto r = get_doc_struct(ifs);
+        auto r = _get_doc_struct(doc.content());
         this->defaults.baseMD.drop( "@docID"
                                   , std::numeric_limits<size_t>::min()
                                   );
+        if( !doc.restart_points().empty() ) {
+            for( auto & block : r ) {
+                if( block.mdSnapshot )
+                    block.restartPoint = doc.restart_point_for(block.blockOffset);
+            }
+        }
         return r;
     }
     
@@ -3062,21 +7519,36 @@ public:  // iLoader interface implementation
                   , IntradocMarkup_t acceptCSVFromLine
                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
                   ) {
-        ParsingState state( grammar
-                          , this->defaults.validityRange
-                          , this->defaults.dataType
-                          , forType
-                          , k
-                          , cllb
-                          , this->defaults.baseMD
-                          );
-        _parse_stream( ifs, state, acceptCSVFromLine, ENABLE_SDC_FIX001 );
+        const std::string content( (std::istreambuf_iterator<char>(ifs))
+                                 , std::istreambuf_iterator<char>() );
+        _read_data( content, k, forType, acceptCSVFromLine, cllb );
+    }
+
+    /** Stream version of single data block reading
+     *
+     * If block has positional markup recorded by `get_doc_struct()`,
+     * re-applies metadata definitions in effect (reading only these lines)
+     * and seeks to the block start, so that parsing cost depends on the
+     * block size rather than on the document size. Otherwise, falls back to
+     * sequential reading.
+     *
+     * Stream must be at the same position as it was for `get_doc_struct()`.
+     */
+    void read_block( std::istream & ifs
+                   , KeyT k
+                   , const std::string & forType
+                   , const typename Documents<KeyT>::DataBlock & block
+                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                   ) {
+        const std::string content( (std::istreambuf_iterator<char>(ifs))
+                                 , std::istreambuf_iterator<char>() );
+        _read_block( content, k, forType, block, cllb );
     }
 
-    /** Opens file and forwards parsing to stream version.
+    /** Maps the file and reads the data sequentially
      *
      * Opens the file (currently, only supports local files), and forwards
-     * invokation to stream version of `read_data()`.
+     * invokation to in-memory version of `read_data()`.
      *
      * \todo Support for remote location.
      */
@@ -3086,19 +7558,949 @@ public:  // iLoader interface implementation
                   , IntradocMarkup_t acceptCSVFromLine
                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
                   ) override {
-        // open file (closed by its destructor at exit)
-        std::ifstream ifs(docID);
+        aux::MappedDocument doc(docID);
         this->defaults.baseMD.set( "@docID"
                                  , docID
                                  , std::numeric_limits<size_t>::min()
                                  );
-        read_data( ifs, k, forType, acceptCSVFromLine, cllb );
+        _read_data( doc.content(), k, forType, acceptCSVFromLine, cllb );
         this->defaults.baseMD.drop( "@docID"
                                   , std::numeric_limits<size_t>::min()
                                   );
     }
+
+    /** Maps the file and reads single block of it.
+     *
+     * Compressed document is decompressed starting from block's restart
+     * point, if any.
+     *
+     * \todo Support for remote location.
+     */
+    void read_block( const std::string & docID
+                   , KeyT k
+                   , const std::string & forType
+                   , const typename Documents<KeyT>::DataBlock & block
+                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                   ) override {
+        aux::MappedDocument doc(docID, _restart_point(block));
+        this->defaults.baseMD.set( "@docID"
+                                 , docID
+                                 , std::numeric_limits<size_t>::min()
+                                 );
+        _read_block( doc.content(), k, forType, block, cllb, doc.base_offset() );
+        this->defaults.baseMD.drop( "@docID"
+                                  , std::numeric_limits<size_t>::min()
+                                  );
+    }
+
+    /**\brief Maps the file and reads single block with statically
+     *         dispatched callback
+     *
+     * Same as `read_block()`, but callback type is the template parameter
+     * and parsing state type is known at compile time, so the parsing
+     * routines, state handlers and the callback may be inlined. Callback
+     * must be invokable as
+     *
+     *      bool(const aux::MetaInfo &, size_t lineNo, std::string_view line)
+     *
+     * (then line is not copied), or with `const std::string &` line.
+     * Used by `Documents::load_static()`.
+     *
+     * \todo Support for remote location.
+     */
+    template<typename CallbackT> void
+    read_block_static( const std::string & docID
+                     , KeyT k
+                     , const std::string & forType
+                     , const typename Documents<KeyT>::DataBlock & block
+                     , CallbackT & cllb
+                     ) {
+        aux::MappedDocument doc(docID, _restart_point(block));
+        this->defaults.baseMD.set( "@docID"
+                                 , docID
+                                 , std::numeric_limits<size_t>::min()
+                                 );
+        const BlockStart bs = _block_start(block);
+        StaticParsingState<CallbackT &> state( grammar
+                                  , bs.validity
+                                  , bs.type
+                                  , forType
+                                  , k
+                                  , cllb
+                                  , bs.md
+                                  );
+        this->defaults.baseMD.drop( "@docID"
+                                  , std::numeric_limits<size_t>::min()
+                                  );
+        aux::LineReader reader(doc.content(), 0, 0, doc.base_offset());
+        _seek_block(reader, block);
+        _parse_lines( reader, state, block.blockBgn, ENABLE_SDC_FIX001 );
+    }
+
+    /** Maps the file and returns cursor over the block rows.
+     *
+     * Rows are parsed lazily, as cursor advances.
+     *
+     * \todo Support for remote location.
+     */
+    std::unique_ptr<typename Documents<KeyT>::iLoader::iRowCursor>
+    open_block( const std::string & docID
+              , KeyT k
+              , const std::string & forType
+              , const typename Documents<KeyT>::DataBlock & block
+              ) override {
+        return std::unique_ptr<typename Documents<KeyT>::iLoader::iRowCursor>(
+                new BlockCursor(*this, docID, k, forType, block));
+    }
+
+    /// Blocks are cacheable when reading is limited by the block
+    bool cacheable_blocks() const override { return ENABLE_SDC_FIX001; }
+
+    /**\brief Requests read-ahead of the blocks content
+     *
+     * Issues `posix_fadvise(POSIX_FADV_WILLNEED)` for the document ranges
+     * the blocks will be read from, so the kernel starts reading them
+     * asynchronously. Compressed documents (having restart points or
+     * compressed file name suffix) are requested from the earliest restart
+     * point to the end.
+     */
+    void prefetch( const std::string & docID
+                 , const std::vector<const typename Documents<KeyT>::DataBlock *> & blocks
+                 ) override {
+        if( blocks.empty() ) return;
+        bool compressed = _compressed_name(docID);
+        for( const auto * block : blocks ) compressed |= bool(block->restartPoint);
+        // ranges of the document to be read, as (offset, length) pairs;
+        // zero length means "till the end"
+        std::vector<std::pair<off_t, off_t>> ranges;
+        for( const auto * block : blocks ) {
+            // blocks without metadata snapshot are read from the start
+            off_t offset = 0;
+            if( compressed ) {
+                const aux::RestartPoint * rp = _restart_point(*block);
+                if( rp ) offset = rp->inOffset;
+            } else if( block->mdSnapshot ) {
+                offset = block->blockOffset;
+            }
+            ranges.emplace_back( offset
+                               , compressed ? 0 : off_t(prefetchSpan) );
+        }
+        // merge overlapping ranges
+        std::sort(ranges.begin(), ranges.end());
+        std::vector<std::pair<off_t, off_t>> merged;
+        for( const auto & r : ranges ) {
+            if( !merged.empty() ) {
+                auto & last = merged.back();
+                if( !last.second ) continue;  // till the end
+                if( r.first <= last.first + last.second ) {
+                    last.second = r.second
+                                ? std::max(last.second, r.first + r.second - last.first)
+                                : 0;
+                    continue;
+                }
+            }
+            merged.push_back(r);
+        }
+        int fd = ::open(docID.c_str(), O_RDONLY | O_CLOEXEC);
+        if( fd < 0 ) return;  // reported on read
+        for( const auto & r : merged ) {
+            posix_fadvise(fd, r.first, r.second, POSIX_FADV_WILLNEED);
+        }
+        close(fd);
+    }
+
+    /// Appends grammar and restart points span to default fingerprint
+    std::string structure_fingerprint() const override {
+        std::ostringstream oss;
+        oss << Documents<KeyT>::iLoader::structure_fingerprint()
+            << ":" << int(GT::comment_char(grammar))
+            << "," << int(GT::metadata_marker(grammar))
+            << "," << GT::key_tag(grammar) << "," << GT::type_tag(grammar)
+            << ":" << restartPointsSpan;
+        return oss.str();
+    }
+
+    /** Maps the file once and reads multiple blocks of it.
+     *
+     * Blocks are read in order of their appearance in the document.
+     *
+     * \todo Support for remote location.
+     */
+    void read_blocks( const std::string & docID
+                    , KeyT k
+                    , const std::vector<typename Documents<KeyT>::iLoader::BlockRead> & reads
+                    ) override {
+        std::vector<const typename Documents<KeyT>::iLoader::BlockRead *> ordered;
+        ordered.reserve(reads.size());
+        for( const auto & r : reads ) ordered.push_back(&r);
+        std::stable_sort( ordered.begin(), ordered.end()
+                , []( const typename Documents<KeyT>::iLoader::BlockRead * a
+                    , const typename Documents<KeyT>::iLoader::BlockRead * b ) {
+                    return a->block->blockOffset < b->block->blockOffset;
+                } );
+        // compressed document is decompressed from the restart point of
+        // the first block, unless some blocks must be read from the start
+        const aux::RestartPoint * from = ordered.empty()
+                                       ? nullptr
+                                       : _restart_point(*ordered.front()->block);
+        for( const auto * r : ordered ) {
+            if( !r->block->mdSnapshot ) from = nullptr;
+        }
+        aux::MappedDocument doc(docID, from);
+        for( const auto * r : ordered ) {
+            if( r->defaults ) this->defaults = *r->defaults;
+            this->defaults.baseMD.set( "@docID"
+                                     , docID
+                                     , std::numeric_limits<size_t>::min()
+                                     );
+            _read_block( doc.content(), k, r->forType, *r->block, r->cllb
+                       , doc.base_offset() );
+            this->defaults.baseMD.drop( "@docID"
+                                      , std::numeric_limits<size_t>::min()
+                                      );
+        }
+    }
 };  // class ExtCSVLoader
 
+//                                                          _________________
+// _______________________________________________________/ Binary Container
+
+namespace aux {
+/**\brief Layout of compiled binary container
+ *
+ * Binary container keeps the result of parsing a set of documents by some
+ * loader: block table (data type, validity range, block start), metadata
+ * snapshots and data rows as they were forwarded by the loader (line number
+ * and stripped line expression), so that reading the data requires no
+ * parsing.
+ *
+ * Container consists of the header, followed by the tables of fixed-size
+ * records and the strings pool. All the integers are 64-bit, of native byte
+ * order (container is not portable across architectures with different
+ * endianness). Records refer each other by index and strings by offset within
+ * the pool.
+ *
+ * \ingroup utils
+ * */
+namespace binfmt {
+/// Magic bytes (and format version) at the container's start
+static constexpr char magic[8] = {'S', 'D', 'C', 'B', 'I', 'N', '0', '1'};
+/// Reference to the string in the strings pool
+struct Str { uint64_t offset, size; };
+/// Container header
+struct Header {
+    char magic[8];
+    uint64_t nDocs, docsOffset
+           , nBlocks, blocksOffset
+           , nRows, rowsOffset
+           , nMDs, mdsOffset
+           , nMDEntries, mdEntriesOffset
+           , stringsOffset, stringsSize
+           ;
+};
+/// Document record; refers to contiguous range of blocks
+struct Document { Str docID; uint64_t firstBlock, nBlocks; };
+/// Data block record; validity bounds are stored as strings (empty if unset)
+struct Block {
+    Str dataType, validFrom, validTo;
+    uint64_t blockBgn, nMD, firstRow, nRows;
+};
+/// Data row record
+struct Row { uint64_t lineNo, nMD; Str expression; };
+/// Metadata snapshot record; refers to contiguous range of entries
+struct MD { uint64_t firstEntry, nEntries; };
+/// Metadata entry record
+struct MDEntry { Str name; uint64_t lineNo; Str value; };
+}  // namespace ::sdc::aux::binfmt
+}  // namespace ::sdc::aux
+
+/**\brief Loader reading compiled binary container
+ *
+ * Reads documents compiled with `compile_binary()` from memory-mapped
+ * container. Documents are identified by their original IDs (returned by
+ * `doc_ids()` in order of compilation), so the container is a drop-in
+ * replacement for the original documents: metadata, line numbers and row
+ * expressions forwarded to the callbacks are the same as ones produced by
+ * the loader used for compilation (with the defaults it had).
+ *
+ * Typical usage:
+ *
+ * \code{.cpp}
+ *     auto binLoader = std::make_shared< sdc::BinaryLoader<int> >("calibs.sdcbin");
+ *     docs.loaders.push_back(binLoader);
+ *     for( const auto & docID : binLoader->doc_ids() ) docs.add(docID);
+ * \endcode
+ *
+ * \throws `errors::IOError` if container can not be read or is malformed.
+ * \ingroup utils
+ * */
+template<typename KeyT>
+class BinaryLoader : public Documents<KeyT>::iLoader {
+public:
+    /// Row cursor over the mapped block rows
+    class BlockCursor : public Documents<KeyT>::iLoader::iRowCursor {
+    private:
+        const BinaryLoader<KeyT> & _loader;
+        const aux::binfmt::Row * _row, * _end;
+        const aux::binfmt::Row * _current;
+        std::string _expression;
+        aux::RowMetaInfo _md;
+    public:
+        BlockCursor( const BinaryLoader<KeyT> & loader
+                   , const aux::binfmt::Row * b
+                   , const aux::binfmt::Row * e
+                   ) : _loader(loader), _row(b), _end(e), _current(nullptr) {}
+        bool next() override {
+            if( _row == _end ) return false;
+            _current = _row++;
+            _expression = _loader._str(_current->expression);
+            _md.at(*_loader._mds[_current->nMD], _current->lineNo);
+            return true;
+        }
+        const aux::MetaInfo & metainfo() const override { return _md.get(); }
+        size_t line_number() const override { return _current->lineNo; }
+        const std::string & expression() const override { return _expression; }
+    };
+private:
+    /// Container path, for error reporting
+    const std::string _path;
+    /// Mapped container
+    aux::MappedDocument _doc;
+    /// Container header
+    const aux::binfmt::Header * _hdr;
+    /// Record tables
+    const aux::binfmt::Document * _docs;
+    const aux::binfmt::Block * _blocks;
+    const aux::binfmt::Row * _rows;
+    /// Strings pool
+    const char * _strings;
+    /// Metadata snapshots
+    std::vector< std::shared_ptr<const aux::MetaInfo> > _mds;
+    /// Document IDs, in order of compilation
+    std::vector<std::string> _docIDs;
+    /// Index of documents by ID
+    std::unordered_map<std::string, size_t> _docsByID;
+
+    /// Returns view on pooled string
+    std::string_view _str( const aux::binfmt::Str & s ) const
+        { return std::string_view(_strings + s.offset, s.size); }
+
+    /// Returns table of certain records, checking its bounds
+    template<typename RecordT> const RecordT *
+    _table( uint64_t offset, uint64_t n ) const {
+        if( offset % alignof(RecordT)
+         || offset > _doc.content().size()
+         || n > (_doc.content().size() - offset)/sizeof(RecordT) )
+            throw errors::IOError(_path, "malformed binary container (bad table)");
+        return reinterpret_cast<const RecordT *>(_doc.content().data() + offset);
+    }
+
+    /// Checks pooled string bounds
+    void _check_str( const aux::binfmt::Str & s ) const {
+        if( s.offset > _hdr->stringsSize || s.size > _hdr->stringsSize - s.offset )
+            throw errors::IOError(_path, "malformed binary container (bad string)");
+    }
+
+    /// Returns validity key from pooled string
+    KeyT _key( const aux::binfmt::Str & s ) const {
+        if( !s.size ) return KeyT(ValidityTraits<KeyT>::unset);
+        return ValidityTraits<KeyT>::from_string(std::string(_str(s)));
+    }
+
+    /// Returns block record referred by data block description
+    const aux::binfmt::Block &
+    _block( const typename Documents<KeyT>::DataBlock & block ) const {
+        if( block.blockOffset >= _hdr->nBlocks )
+            throw errors::LoaderAPIError( const_cast<BinaryLoader<KeyT>*>(this)
+                    , "block was not indexed by binary loader" );
+        return _blocks[block.blockOffset];
+    }
+
+    /// Returns whether rows of the block shall be read for certain key and
+    /// type (same condition as for `ExtCSVLoader`)
+    bool _accepts( const aux::binfmt::Block & b
+                 , KeyT k
+                 , const std::string & forType
+                 ) const {
+        if( _str(b.dataType) != forType ) return false;
+        const KeyT from = _key(b.validFrom)
+                 , to = _key(b.validTo);
+        if( ValidityTraits<KeyT>::is_set(from) && k < from ) return false;
+        if( ValidityTraits<KeyT>::is_set(to) && (to < k || to == k) ) return false;
+        return true;
+    }
+
+    /// Forwards rows of the block to callback
+    template<typename CallbackT> void
+    _read_rows( const aux::binfmt::Block & b, CallbackT & cllb ) const {
+        const aux::binfmt::Row * row = _rows + b.firstRow
+                             , * end = row + b.nRows;
+        aux::RowMetaInfo md;  // snapshots are shared, not modified
+        for( ; row != end; ++row ) {
+            const aux::MetaInfo & rowMD = md.at(*_mds[row->nMD], row->lineNo);
+            if constexpr (std::is_invocable_v< CallbackT &, const aux::MetaInfo &
+                                             , size_t, std::string_view>) {
+                cllb(rowMD, row->lineNo, _str(row->expression));
+            } else {
+                cllb(rowMD, row->lineNo, std::string(_str(row->expression)));
+            }
+        }
+    }
+public:
+    /// Maps the container and reads its tables
+    BinaryLoader( const std::string & path );
+
+    /// Returns IDs of the documents in container, in order of compilation
+    const std::vector<std::string> & doc_ids() const { return _docIDs; }
+
+    /// Handles documents kept in container
+    bool can_handle( const std::string & docID ) const override
+        { return _docsByID.end() != _docsByID.find(docID); }
+
+    /**\brief Returns document structure as it was retrieved at compilation
+     *
+     * Byte offset of returned data blocks is index of the block in
+     * container.
+     *
+     * \throws `errors::IOError` if document is not in container
+     */
+    std::list<typename Documents<KeyT>::DataBlock>
+    get_doc_struct( const std::string & docID ) override {
+        auto it = _docsByID.find(docID);
+        if( _docsByID.end() == it )
+            throw errors::IOError(docID, "document is not in binary container \""
+                    + _path + "\"");
+        const aux::binfmt::Document & d = _docs[it->second];
+        std::list<typename Documents<KeyT>::DataBlock> r;
+        for( uint64_t nBlock = d.firstBlock; nBlock < d.firstBlock + d.nBlocks; ++nBlock ) {
+            const aux::binfmt::Block & b = _blocks[nBlock];
+            r.push_back(typename Documents<KeyT>::DataBlock{
+                      std::string(_str(b.dataType))
+                    , ValidityRange<KeyT>{_key(b.validFrom), _key(b.validTo)}
+                    , b.blockBgn
+                    , nBlock
+                    , _mds[b.nMD]
+                    });
+        }
+        return r;
+    }
+
+    /**\brief Reads rows of the document's blocks sequentially
+     *
+     * Same as `ExtCSVLoader::read_data()`: blocks starting before
+     * `acceptFrom` are omitted and, unless `acceptFrom` is zero, only the
+     * first block is read (if `ENABLE_SDC_FIX001` is set).
+     */
+    void read_data( const std::string & docID
+                  , KeyT k
+                  , const std::string & forType
+                  , IntradocMarkup_t acceptFrom
+                  , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                  ) override {
+        for( const auto & block : get_doc_struct(docID) ) {
+            if( block.blockBgn < acceptFrom ) continue;
+            const aux::binfmt::Block & b = _block(block);
+            if( _accepts(b, k, forType) ) _read_rows(b, cllb);
+            if( acceptFrom && ENABLE_SDC_FIX001 ) break;
+        }
+    }
+
+    /// Reads rows of single block
+    void read_block( const std::string & docID
+                   , KeyT k
+                   , const std::string & forType
+                   , const typename Documents<KeyT>::DataBlock & block
+                   , typename Documents<KeyT>::iLoader::ReaderCallback cllb
+                   ) override {
+        const aux::binfmt::Block & b = _block(block);
+        if( _accepts(b, k, forType) ) _read_rows(b, cllb);
+    }
+
+    /**\brief Reads rows of single block with statically dispatched callback
+     *
+     * Same as `ExtCSVLoader::read_block_static()`, used by
+     * `Documents::load_static()`.
+     */
+    template<typename CallbackT> void
+    read_block_static( const std::string & docID
+                     , KeyT k
+                     , const std::string & forType
+                     , const typename Documents<KeyT>::DataBlock & block
+                     , CallbackT & cllb
+                     ) {
+        const aux::binfmt::Block & b = _block(block);
+        if( _accepts(b, k, forType) ) _read_rows(b, cllb);
+    }
+
+    /// Returns cursor over mapped rows of the block
+    std::unique_ptr<typename Documents<KeyT>::iLoader::iRowCursor>
+    open_block( const std::string & docID
+              , KeyT k
+              , const std::string & forType
+              , const typename Documents<KeyT>::DataBlock & block
+              ) override {
+        const aux::binfmt::Block & b = _block(block);
+        const aux::binfmt::Row * bgn = _rows + b.firstRow
+                             , * end = _accepts(b, k, forType) ? bgn + b.nRows : bgn;
+        return std::unique_ptr<typename Documents<KeyT>::iLoader::iRowCursor>(
+                new BlockCursor(*this, bgn, end));
+    }
+
+    /// Blocks are cacheable as they were for loader used for compilation
+    bool cacheable_blocks() const override { return ENABLE_SDC_FIX001; }
+};  // class BinaryLoader
+
+template<typename KeyT>
+BinaryLoader<KeyT>::BinaryLoader( const std::string & path )
+        : _path(path), _doc(path) {
+    const std::string_view c = _doc.content();
+    if( c.size() < sizeof(aux::binfmt::Header)
+     || 0 != memcmp(c.data(), aux::binfmt::magic, sizeof(aux::binfmt::magic)) )
+        throw errors::IOError(path, "not a binary SDC container");
+    _hdr = reinterpret_cast<const aux::binfmt::Header *>(c.data());
+    _docs = _table<aux::binfmt::Document>(_hdr->docsOffset, _hdr->nDocs);
+    _blocks = _table<aux::binfmt::Block>(_hdr->blocksOffset, _hdr->nBlocks);
+    _rows = _table<aux::binfmt::Row>(_hdr->rowsOffset, _hdr->nRows);
+    const auto * mds = _table<aux::binfmt::MD>(_hdr->mdsOffset, _hdr->nMDs);
+    const auto * mdEntries = _table<aux::binfmt::MDEntry>( _hdr->mdEntriesOffset
+                                                         , _hdr->nMDEntries );
+    _strings = _table<char>(_hdr->stringsOffset, _hdr->stringsSize);
+    // validate references, so that reading needs no checks
+    for( uint64_t i = 0; i < _hdr->nMDEntries; ++i ) {
+        _check_str(mdEntries[i].name);
+        _check_str(mdEntries[i].value);
+    }
+    _mds.reserve(_hdr->nMDs);
+    for( uint64_t i = 0; i < _hdr->nMDs; ++i ) {
+        if( mds[i].firstEntry > _hdr->nMDEntries
+         || mds[i].nEntries > _hdr->nMDEntries - mds[i].firstEntry )
+            throw errors::IOError(path, "malformed binary container (bad metadata)");
+        auto md = std::make_shared<aux::MetaInfo>();
+        for( uint64_t j = mds[i].firstEntry; j < mds[i].firstEntry + mds[i].nEntries; ++j ) {
+            md->set( std::string(_str(mdEntries[j].name))
+                   , std::string(_str(mdEntries[j].value))
+                   , mdEntries[j].lineNo );
+        }
+        _mds.push_back(md);
+    }
+    for( uint64_t i = 0; i < _hdr->nRows; ++i ) {
+        _check_str(_rows[i].expression);
+        if( _rows[i].nMD >= _hdr->nMDs )
+            throw errors::IOError(path, "malformed binary container (bad row)");
+    }
+    for( uint64_t i = 0; i < _hdr->nBlocks; ++i ) {
+        const aux::binfmt::Block & b = _blocks[i];
+        _check_str(b.dataType);
+        _check_str(b.validFrom);
+        _check_str(b.validTo);
+        if( b.nMD >= _hdr->nMDs || b.firstRow > _hdr->nRows
+         || b.nRows > _hdr->nRows - b.firstRow )
+            throw errors::IOError(path, "malformed binary container (bad block)");
+    }
+    _docIDs.reserve(_hdr->nDocs);
+    for( uint64_t i = 0; i < _hdr->nDocs; ++i ) {
+        _check_str(_docs[i].docID);
+        if( _docs[i].firstBlock > _hdr->nBlocks
+         || _docs[i].nBlocks > _hdr->nBlocks - _docs[i].firstBlock )
+            throw errors::IOError(path, "malformed binary container (bad document)");
+        _docIDs.emplace_back(_str(_docs[i].docID));
+        _docsByID.emplace(_docIDs.back(), i);
+    }
+}
+
+/**\brief Compiles documents into binary container
+ *
+ * Retrieves structure of each document with given loader and reads all rows
+ * of each block, storing them in the container to be read by
+ * `BinaryLoader`. Loader's defaults (default data type, validity range, base
+ * metadata) are applied as for usual indexing, so they must be the same as
+ * ones used in production. Loader must permit caching of the blocks (see
+ * `iLoader::cacheable_blocks()`), i.e. rows must depend only on the block.
+ *
+ * Validity keys are stored with `ValidityTraits<KeyT>::to_string()` and
+ * restored with `from_string()`.
+ *
+ * \returns number of blocks written.
+ * \throws `errors::LoaderAPIError` if loader does not permit block caching
+ * \throws `errors::IOError` if output can not be written
+ *
+ * \ingroup utils
+ * */
+template<typename KeyT> size_t
+compile_binary( typename Documents<KeyT>::iLoader & loader
+              , const std::vector<std::string> & docIDs
+              , const std::string & outPath
+              ) {
+    if( !loader.cacheable_blocks() )
+        throw errors::LoaderAPIError( &loader, "loader does not permit block"
+                " caching; can not compile binary container" );
+    namespace bf = aux::binfmt;
+    std::vector<bf::Document> docs;
+    std::vector<bf::Block> blocks;
+    std::vector<bf::Row> rows;
+    std::vector<bf::MD> mds;
+    std::vector<bf::MDEntry> mdEntries;
+    std::string strings;
+    // appends string to the pool
+    auto str = [&]( std::string_view s ) {
+        strings.append(s.data(), s.size());
+        return bf::Str{ strings.size() - s.size(), s.size() };
+    };
+    auto key_str = [&]( KeyT k ) {
+        return ValidityTraits<KeyT>::is_set(k)
+             ? str(ValidityTraits<KeyT>::to_string(k))
+             : bf::Str{0, 0};
+    };
+    // serializes metadata snapshot
+    auto add_md = [&]( const aux::MetaInfo & md ) {
+        mds.push_back(bf::MD{ mdEntries.size(), md.size() });
+        for( const auto & entry : md ) {
+            mdEntries.push_back(bf::MDEntry{ str(entry.first)
+                                           , entry.second.first
+                                           , str(entry.second.second) });
+        }
+        return mds.size() - 1;
+    };
+    for( const auto & docID : docIDs ) {
+        const auto docStruct = loader.get_doc_struct(docID);
+        // snapshots shared between blocks are written once
+        std::unordered_map<const aux::MetaInfo *, uint64_t> snapshots;
+        docs.push_back(bf::Document{ str(docID), blocks.size(), docStruct.size() });
+        for( const auto & block : docStruct ) {
+            // no snapshot -- block's metadata is one of the first row
+            uint64_t nBlockMD = std::numeric_limits<uint64_t>::max();
+            if( block.mdSnapshot ) {
+                auto ir = snapshots.emplace(block.mdSnapshot.get(), 0);
+                if( ir.second ) ir.first->second = add_md(*block.mdSnapshot);
+                nBlockMD = ir.first->second;
+            }
+            bf::Block b{ str(block.dataType)
+                       , key_str(block.validityRange.from)
+                       , key_str(block.validityRange.to)
+                       , block.blockBgn
+                       , nBlockMD
+                       , rows.size()
+                       , 0
+                       };
+            // Metadata may be changed within a block (by entries not
+            // affecting block's type or validity); since metadata entries
+            // are only added while parsing, change is detected by entries
+            // count (or by other object, for generic loader)
+            const aux::MetaInfo * lastMD = block.mdSnapshot.get();
+            size_t lastMDSize = lastMD ? lastMD->size() : 0;
+            uint64_t nMD = nBlockMD;
+            loader.read_block( docID
+                    , block.validityRange.from
+                    , block.dataType
+                    , block
+                    , [&]( const aux::MetaInfo & md
+                         , size_t lineNo
+                         , const std::string & expression ) {
+                        if( &md != lastMD || md.size() != lastMDSize ) {
+                            if( !( block.mdSnapshot && rows.size() == b.firstRow
+                                && md.size() == block.mdSnapshot->size() ) ) {
+                                nMD = add_md(md);
+                            }
+                            lastMD = &md;
+                            lastMDSize = md.size();
+                        }
+                        rows.push_back(bf::Row{lineNo, nMD, str(expression)});
+                        return true;
+                    } );
+            b.nRows = rows.size() - b.firstRow;
+            if( !block.mdSnapshot )
+                b.nMD = b.nRows ? rows[b.firstRow].nMD : add_md(aux::MetaInfo());
+            blocks.push_back(b);
+        }
+    }
+    // write the container
+    bf::Header hdr;
+    memcpy(hdr.magic, bf::magic, sizeof(hdr.magic));
+    uint64_t offset = sizeof(bf::Header);
+    auto place = [&]( uint64_t & n, uint64_t & off, size_t nItems, size_t itemSize ) {
+        n = nItems;
+        off = offset;
+        offset += nItems*itemSize;
+    };
+    place(hdr.nDocs, hdr.docsOffset, docs.size(), sizeof(bf::Document));
+    place(hdr.nBlocks, hdr.blocksOffset, blocks.size(), sizeof(bf::Block));
+    place(hdr.nRows, hdr.rowsOffset, rows.size(), sizeof(bf::Row));
+    place(hdr.nMDs, hdr.mdsOffset, mds.size(), sizeof(bf::MD));
+    place(hdr.nMDEntries, hdr.mdEntriesOffset, mdEntries.size(), sizeof(bf::MDEntry));
+    place(hdr.stringsSize, hdr.stringsOffset, strings.size(), 1);
+    std::ofstream ofs(outPath, std::ios::binary | std::ios::trunc);
+    if( !ofs )
+        throw errors::IOError(outPath, "could not open file for writing");
+    ofs.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    ofs.write(reinterpret_cast<const char *>(docs.data()), docs.size()*sizeof(bf::Document));
+    ofs.write(reinterpret_cast<const char *>(blocks.data()), blocks.size()*sizeof(bf::Block));
+    ofs.write(reinterpret_cast<const char *>(rows.data()), rows.size()*sizeof(bf::Row));
+    ofs.write(reinterpret_cast<const char *>(mds.data()), mds.size()*sizeof(bf::MD));
+    ofs.write(reinterpret_cast<const char *>(mdEntries.data()), mdEntries.size()*sizeof(bf::MDEntry));
+    ofs.write(strings.data(), strings.size());
+    if( !ofs )
+        throw errors::IOError(outPath, "failed to write binary container");
+    return blocks.size();
+}
+
+//                                                         ____________________
+// ______________________________________________________/ Watching Documents
+
+/**\brief Keeps documents index in sync with filesystem subtree
+ *
+ * Intended for long-running processes keeping `Documents` instance alive
+ * for a long time. Watches FS roots given in the same form as for
+ * `aux::FS` (colon-separated paths, accept/reject patterns, size limits) and
+ * on `poll()` adds new documents, re-indexes changed ones and drops
+ * vanished ones, so only affected documents are (re-)parsed. Changes are
+ * detected by size and modification time.
+ *
+ * On Linux, inotify is used to find out whether anything has changed
+ * within the watched subtree, so `poll()` is nearly free when nothing
+ * happened; `fd()` can be used to wait for changes with `poll(2)` or
+ * `select(2)`. Otherwise (or if inotify is not available, e.g. due to
+ * limits) subtree is walked on each `poll()`.
+ *
+ * Documents found in the subtree at construction are assumed to be
+ * already indexed (e.g. with `Documents::add_from()` and `aux::FS` of the
+ * same parameters). Collections loaded from changed documents can be
+ * identified as outdated with `Documents::generation()`.
+ *
+ * Errors of re-indexing a document (e.g. one being written) are not
+ * propagated: document is counted in `Changes::nErrors` and re-indexed again
+ * on its next change. If `poll()` is interrupted by an exception anyway,
+ * documents not handled yet are handled by the next `poll()`.
+ *
+ * \warning Documents shall be updated by atomic rename of the new version
+ *          over the old one. Large documents are mapped while being read
+ *          (see `aux::MappedDocument`), and truncation of the file being
+ *          read in place raises `SIGBUS`.
+ *
+ * \ingroup utils
+ * */
+template<typename KeyT>
+class DocumentsWatcher {
+public:
+    /// Document state type used to detect changes
+    typedef typename Documents<KeyT>::DocState DocState;
+    /// Changes applied to the index by `poll()`
+    struct Changes {
+        /// Lists of added, re-indexed and removed documents
+        std::vector<std::string> added, updated, removed;
+        /// Number of documents that failed to (re-)index
+        size_t nErrors;
+
+        Changes() : nErrors(0) {}
+        bool empty() const { return added.empty() && updated.empty() && removed.empty(); }
+    };
+    /// If set, (re-)indexing errors are printed to this stream
+    std::ostream * logStreamPtr;
+protected:
+    /// Index being maintained
+    Documents<KeyT> & _docs;
+    /// FS traversal parameters
+    const std::string _paths, _acceptPatterns, _rejectPatterns;
+    const ::off_t _fileSizeMin, _fileSizeMax;
+    /// Known documents with their state
+    std::unordered_map<std::string, DocState> _known;
+    /// inotify instance descriptor, negative if polling mode is used
+    int _inotifyFD;
+    /// Watched directories, by watch descriptors
+    std::unordered_map<int, std::string> _watches;
+    /// Set while `poll()` applies changes; if remains set, previous
+    /// `poll()` was interrupted and subtree must be re-scanned
+    bool _interrupted;
+
+    /// Walks the subtree collecting documents state
+    std::unordered_map<std::string, DocState> _scan() const {
+        std::unordered_map<std::string, DocState> found;
+        aux::FS fs(_paths, _acceptPatterns, _rejectPatterns, _fileSizeMin, _fileSizeMax);
+        for( std::string docID = fs(); !docID.empty(); docID = fs() ) {
+            DocState ds;
+            if( ds.stat(docID) ) found.emplace(docID, ds);
+        }
+        return found;
+    }
+
+    /// Adds inotify watches on directory and its subdirectories
+    void _watch_tree( const std::string & dir );
+
+    /// Reads pending inotify events, returns `true` if there were any
+    bool _drain_events();
+public:
+    /**\brief Starts watching FS subtree
+     *
+     * If `useINotify` is not set (or inotify is not available), polling
+     * mode is used.
+     * */
+    DocumentsWatcher( Documents<KeyT> & docs
+                    , const std::string & paths
+                    , const std::string & acceptPatterns="*.txt:*.dat:*.txt.gz:*.dat.gz:*.txt.xz:*.dat.xz:*.txt.zst:*.dat.zst"
+                    , const std::string & rejectPatterns="*.swp:*.swo:*.bak:*.BAK:*.bck:~*:*-orig.txt:*.dev"
+                    , ::off_t fileSizeMin=10, ::off_t fileSizeMax=1024*1024*1024
+                    , bool useINotify=true
+                    ) : logStreamPtr(nullptr)
+                      , _docs(docs)
+                      , _paths(paths)
+                      , _acceptPatterns(acceptPatterns)
+                      , _rejectPatterns(rejectPatterns)
+                      , _fileSizeMin(fileSizeMin)
+                      , _fileSizeMax(fileSizeMax)
+                      , _inotifyFD(-1)
+                      , _interrupted(false)
+                      {
+        #if !SDC_NO_INOTIFY
+        if( useINotify ) {
+            _inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            for( const auto & path : aux::tokenize(_paths, ':') ) {
+                if( path.empty() || _inotifyFD < 0 ) continue;
+                struct stat st;
+                if( 0 != ::stat(path.c_str(), &st) ) continue;
+                if( S_ISDIR(st.st_mode) ) {
+                    _watch_tree(path);
+                } else {
+                    // file is watched by its dir, as editors and copying
+                    // tools usually replace files
+                    const size_t n = path.rfind('/');
+                    _watch_tree(n == std::string::npos ? "." : path.substr(0, n + 1));
+                }
+            }
+        }
+        #else
+        (void) useINotify;
+        #endif
+        _known = _scan();
+    }
+
+    DocumentsWatcher(const DocumentsWatcher &) = delete;
+
+    ~DocumentsWatcher() {
+        if( _inotifyFD >= 0 ) close(_inotifyFD);
+    }
+
+    /// Returns whether inotify is used (otherwise, subtree is polled)
+    bool uses_inotify() const { return _inotifyFD >= 0; }
+
+    /// Returns inotify descriptor (becomes readable on changes) or -1
+    int fd() const { return _inotifyFD; }
+
+    /**\brief Applies changes in FS subtree to the index
+     *
+     * New documents are added with `Documents::add()`, changed ones are
+     * re-indexed with `Documents::reindex()` and vanished ones are removed
+     * with `Documents::drop_document()`.
+     * */
+    Changes poll() {
+        Changes changes;
+        if( _inotifyFD >= 0 && !_drain_events() && !_interrupted ) return changes;
+        _interrupted = true;
+        const auto found = _scan();
+        // known documents state is updated as they are handled
+        for( auto it = _known.begin(); it != _known.end(); ) {
+            if( found.count(it->first) ) { ++it; continue; }
+            _docs.drop_document(it->first);
+            changes.removed.push_back(it->first);
+            it = _known.erase(it);
+        }
+        for( const auto & p : found ) {
+            auto it = _known.find(p.first);
+            if( it != _known.end() && it->second == p.second ) continue;
+            const bool isNew = it == _known.end();
+            bool indexed = true;
+            try {
+                if( isNew ) {
+                    indexed = _docs.add(p.first);
+                } else {
+                    _docs.reindex(p.first);
+                }
+            } catch( std::exception & e ) {
+                // entries may be partially added
+                _docs.drop_document(p.first);
+                ++changes.nErrors;
+                indexed = false;
+                if( logStreamPtr )
+                    *logStreamPtr << "Failed to index \"" << p.first
+                                  << "\": " << e.what() << std::endl;
+            }
+            _known[p.first] = p.second;
+            if( indexed )
+                (isNew ? changes.added : changes.updated).push_back(p.first);
+        }
+        _interrupted = false;
+        return changes;
+    }
+};  // class DocumentsWatcher
+
+#if !SDC_NO_INOTIFY
+template<typename KeyT> void
+DocumentsWatcher<KeyT>::_watch_tree( const std::string & dir ) {
+    const uint32_t mask = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE
+                        | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF
+                        | IN_MOVE_SELF | IN_ONLYDIR
+                        ;
+    struct DirsWalker : public aux::FTSBase {
+        bool _fits( FTSENT * c ) const override { return c->fts_info == FTS_D; }
+        DirsWalker( char * const * input ) : aux::FTSBase(input) {}
+    };
+    std::vector<std::string> dirs = {dir};
+    {
+        const char * input[] = {dir.c_str(), NULL};
+        DirsWalker walker(const_cast<char * const *>(input));
+        for( std::string sub = walker(); !sub.empty(); sub = walker() )
+            dirs.push_back(sub);
+    }
+    for( const auto & d : dirs ) {
+        const int wd = inotify_add_watch(_inotifyFD, d.c_str(), mask);
+        if( wd < 0 ) {
+            // e.g. out of watches -- fall back to polling
+            close(_inotifyFD);
+            _inotifyFD = -1;
+            _watches.clear();
+            return;
+        }
+        _watches[wd] = d;
+    }
+}
+
+template<typename KeyT> bool
+DocumentsWatcher<KeyT>::_drain_events() {
+    alignas(struct inotify_event) char buf[4096];
+    bool hadEvents = false;
+    std::vector<std::string> newDirs;
+    for(;;) {
+        const ssize_t n = read(_inotifyFD, buf, sizeof(buf));
+        if( n <= 0 ) break;  // EAGAIN -- no more events
+        hadEvents = true;
+        for( char * p = buf; p < buf + n; ) {
+            const struct inotify_event * ev
+                    = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+            if( ev->mask & IN_IGNORED ) {
+                _watches.erase(ev->wd);
+                continue;
+            }
+            if( !( (ev->mask & IN_ISDIR)
+                && (ev->mask & (IN_CREATE | IN_MOVED_TO)) && ev->len ) )
+                continue;
+            // new subdirectory appeared -- watch it as well
+            auto it = _watches.find(ev->wd);
+            if( it != _watches.end() )
+                newDirs.push_back(it->second + "/" + ev->name);
+        }
+    }
+    for( const auto & dir : newDirs ) {
+        if( _inotifyFD >= 0 ) _watch_tree(dir);
+    }
+    return hadEvents;
+}
+#else
+template<typename KeyT> void
+DocumentsWatcher<KeyT>::_watch_tree( const std::string & ) {}
+
+template<typename KeyT> bool
+DocumentsWatcher<KeyT>::_drain_events() { return true; }
+#endif
+
 //                                                                      _______
 // ___________________________________________________________________/ Utils
 
@@ -3114,7 +8516,7 @@ template<typename KeyT, typename DataTypeT>
 typename CalibDataTraits<DataTypeT>::template Collection<DataTypeT>
 load_from_fs( const std::string & rootpath
             , KeyT k
-            , const std::string & acceptPatterns="*.txt:*.dat"
+            , const std::string & acceptPatterns="*.txt:*.dat:*.txt.gz:*.dat.gz:*.txt.xz:*.dat.xz:*.txt.zst:*.dat.zst"
             , const std::string & rejectPatterns="*.swp:*.swo:*.bak:*.BAK:*.bck:~*:*-orig.txt:*.dev"
             , size_t upSizeLimitBytes=1024*1024*1024
             , std::ostream * logStreamPtr=nullptr
@@ -3161,7 +8563,9 @@ load_from_fs( const std::string & rootpath
     // However, for `CaloCellCalib` it is requested to apply additional check
     // on the origin, so we use a templated wrapper `SrcInfo<T>` here to
     // gain some info on the source document for every entry.
-    return docs.template load< DataTypeT >(k);
+    // Since the only loader here is the ExtCSV one, statically dispatched
+    // version of `load()` is used.
+    return docs.template load_static< DataTypeT, ExtCSVLoader<KeyT> >(k);
 }
 
 /**\brief Prints loading log as JSON data (for debugging)
@@ -0,0 +1,1269 @@
+#include "sdc.hh"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <thread>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifndef SDC_NO_ZLIB
+#   include <zlib.h>
+#endif
+#ifndef SDC_NO_LZMA
+#   include <lzma.h>
+#endif
+#ifndef SDC_NO_ZSTD
+#   include <zstd.h>
+#endif
+
+namespace sdc {
+namespace test {
+
+/// Item of first testing type (integer pair)
+struct MultiA {
+    int a, b;
+    size_t lineNo;
+};
+
+/// Item of second testing type (label and value)
+struct MultiB {
+    std::string label;
+    float value;
+    size_t lineNo;
+};
+
+/// Same as `MultiB`, but parsed with typed columns schema
+struct TypedB {
+    std::string label;
+    float value;
+    int extra;
+    size_t lineNo;
+};
+
+}  // namespace ::sdc::test
+
+template<>
+struct CalibDataTraits<test::MultiA> {
+    static constexpr auto typeName = "TestData/MultiA";
+    template<typename T=test::MultiA> using Collection=std::vector<T>;
+    template<typename T=test::MultiA>
+    static inline void collect( Collection<T> & col
+                              , const T & item
+                              , const aux::MetaInfo &
+                              , size_t
+                              ) { col.push_back(item); }
+    static test::MultiA
+            parse_line( const std::string & line
+                      , size_t lineNo
+                      , const aux::MetaInfo & m
+                      , const std::string &
+                      , sdc::aux::LoadLog * loadLogPtr=nullptr
+                      ) {
+        auto csv = m.get<aux::ColumnsOrder>("columns")
+            .interpret(aux::tokenize(line), loadLogPtr);
+        return test::MultiA{csv("a", 0), csv("b", 0), lineNo};
+    }
+};
+
+template<>
+struct CalibDataTraits<test::MultiB> {
+    static constexpr auto typeName = "TestData/MultiB";
+    template<typename T=test::MultiB> using Collection=std::vector<T>;
+    template<typename T=test::MultiB>
+    static inline void collect( Collection<T> & col
+                              , const T & item
+                              , const aux::MetaInfo &
+                              , size_t
+                              ) { col.push_back(item); }
+    static test::MultiB
+            parse_line( const std::string & line
+                      , const RowContext & ctx
+                      ) {
+        EXPECT_EQ(ctx.md.get<std::string>("@docID"), ctx.docID);
+        // legacy per-row metadata is provided without being stored
+        EXPECT_EQ(ctx.md.get<size_t>("@lineNo"), ctx.lineNo);
+        // rows are parsed within loading operation, having arena
+        EXPECT_NE(nullptr, ctx.arena);
+        EXPECT_EQ(aux::Arena::current(), ctx.arena);
+        auto csv = ctx.md.get<aux::ColumnsOrder>("columns")
+            .interpret(aux::tokenize(line), ctx.loadLogPtr);
+        return test::MultiB{csv("label"), csv("value", 0.f), ctx.lineNo};
+    }
+};
+
+template<>
+struct CalibDataTraits<test::TypedB> {
+    static constexpr auto typeName = "TestData/MultiB";
+    template<typename T=test::TypedB> using Collection=std::vector<T>;
+    template<typename T=test::TypedB>
+    static inline void collect( Collection<T> & col
+                              , const T & item
+                              , const aux::MetaInfo &
+                              , size_t
+                              ) { col.push_back(item); }
+    static inline const auto schema = aux::columns_schema(
+                  aux::column("label", &test::TypedB::label)
+                , aux::column("value", &test::TypedB::value, 0.f)
+                , aux::column("extra", &test::TypedB::extra, -1)
+                );
+    static test::TypedB
+            parse_line( const std::string & line
+                      , const RowContext & ctx
+                      ) {
+        test::TypedB item = schema.parse(line, ctx);
+        item.lineNo = ctx.lineNo;
+        return item;
+    }
+};
+
+namespace test {
+
+static const char tstMultiDoc1[] = R"TST(# first document
+runs=1-...
+type=TestData/MultiA
+columns=a, b
+1 2
+3 4
+
+type=TestData/MultiB
+columns=label, value
+one 1.5
+
+runs=5-...
+type=TestData/MultiA
+columns=a, b
+10 20
+)TST";
+
+static const char tstMultiDoc2[] = R"TST(# second document
+runs=3-...
+type=TestData/MultiB
+columns=label, value
+two 2.5
+three 3.5
+
+type=TestData/MultiA
+columns=b, a
+6 5
+)TST";
+
+/// ExtCSV loader counting document reads
+struct CountingLoader : public ExtCSVLoader<int> {
+    size_t nBlockReads, nMultiReads, nStructReads;
+    std::vector<std::pair<std::string, size_t>> prefetches;
+    CountingLoader() : nBlockReads(0), nMultiReads(0), nStructReads(0) {}
+    void prefetch( const std::string & docID
+                 , const std::vector<const Documents<int>::DataBlock *> & blocks
+                 ) override {
+        prefetches.emplace_back(docID, blocks.size());
+        ExtCSVLoader<int>::prefetch(docID, blocks);
+    }
+    std::list<Documents<int>::DataBlock>
+    get_doc_struct( const std::string & docID ) override {
+        ++nStructReads;
+        return ExtCSVLoader<int>::get_doc_struct(docID);
+    }
+    void read_block( const std::string & docID
+                   , int k
+                   , const std::string & forType
+                   , const Documents<int>::DataBlock & block
+                   , Documents<int>::iLoader::ReaderCallback cllb
+                   ) override {
+        ++nBlockReads;
+        ExtCSVLoader<int>::read_block(docID, k, forType, block, cllb);
+    }
+    void read_blocks( const std::string & docID
+                    , int k
+                    , const std::vector<Documents<int>::iLoader::BlockRead> & reads
+                    ) override {
+        ++nMultiReads;
+        ExtCSVLoader<int>::read_blocks(docID, k, reads);
+    }
+};
+
+class MultiTypeDocuments : public ::testing::Test {
+protected:
+    std::shared_ptr<CountingLoader> loader;
+    Documents<int> docs;
+
+    void SetUp() override {
+        loader = std::make_shared<CountingLoader>();
+        docs.loaders.push_back(loader);
+        const std::pair<std::string, const char *> srcs[] = {
+                { ::testing::TempDir() + "sdc-multi-1.txt", tstMultiDoc1 },
+                { ::testing::TempDir() + "sdc-multi-2.txt", tstMultiDoc2 },
+            };
+        for( const auto & src : srcs ) {
+            std::ofstream ofs(src.first);
+            ofs << src.second;
+            ofs.close();
+            ASSERT_TRUE(docs.add(src.first));
+        }
+    }
+};
+
+TEST_F( MultiTypeDocuments, loadsMultipleTypesAsSequentialLoads ) {
+    for( int k : {1, 3, 6} ) {
+        auto as = docs.load<MultiA>(k);
+        auto bs = docs.load<MultiB>(k);
+        auto both = docs.load<MultiA, MultiB>(k);
+        const auto & as2 = std::get<0>(both);
+        const auto & bs2 = std::get<1>(both);
+        ASSERT_EQ(as.size(), as2.size()) << " for key " << k;
+        for( size_t i = 0; i < as.size(); ++i ) {
+            EXPECT_EQ(as[i].a, as2[i].a);
+            EXPECT_EQ(as[i].b, as2[i].b);
+            EXPECT_EQ(as[i].lineNo, as2[i].lineNo);
+        }
+        ASSERT_EQ(bs.size(), bs2.size()) << " for key " << k;
+        for( size_t i = 0; i < bs.size(); ++i ) {
+            EXPECT_EQ(bs[i].label, bs2[i].label);
+            EXPECT_EQ(bs[i].value, bs2[i].value);
+            EXPECT_EQ(bs[i].lineNo, bs2[i].lineNo);
+        }
+    }
+    // check actual values at the latest key
+    auto both = docs.load<MultiA, MultiB>(6);
+    const auto & as = std::get<0>(both);
+    ASSERT_EQ(as.size(), 4);
+    EXPECT_EQ(as[0].a, 1);  EXPECT_EQ(as[0].b, 2);
+    EXPECT_EQ(as[1].a, 3);  EXPECT_EQ(as[1].b, 4);
+    EXPECT_EQ(as[2].a, 5);  EXPECT_EQ(as[2].b, 6);  // second doc, reordered
+    EXPECT_EQ(as[3].a, 10); EXPECT_EQ(as[3].b, 20);
+    const auto & bs = std::get<1>(both);
+    ASSERT_EQ(bs.size(), 3);
+    EXPECT_EQ(bs[0].label, "one");
+    EXPECT_EQ(bs[1].label, "two");
+    EXPECT_EQ(bs[2].label, "three");
+}
+
+TEST_F( MultiTypeDocuments, readsEachDocumentOnce ) {
+    loader->nBlockReads = loader->nMultiReads = 0;
+    docs.load<MultiA, MultiB>(6);
+    EXPECT_EQ(loader->nMultiReads, 2);
+    EXPECT_EQ(loader->nBlockReads, 0);
+}
+
+TEST_F( MultiTypeDocuments, prefetchesDocumentsBeforeReading ) {
+    const std::string docIDs[] = { ::testing::TempDir() + "sdc-multi-1.txt"
+                                 , ::testing::TempDir() + "sdc-multi-2.txt"
+                                 };
+    docs.load<MultiA>(6);
+    ASSERT_EQ(loader->prefetches.size(), 2);
+    EXPECT_EQ(loader->prefetches[0].first, docIDs[0]);
+    EXPECT_EQ(loader->prefetches[1].first, docIDs[1]);
+    // each document is hinted once, with all the blocks of all types
+    loader->prefetches.clear();
+    docs.load<MultiA, MultiB>(6);
+    ASSERT_EQ(loader->prefetches.size(), 2);
+    EXPECT_EQ( loader->prefetches[0].second + loader->prefetches[1].second
+             , docs.validityIndex.updates("TestData/MultiA", 6).size()
+             + docs.validityIndex.updates("TestData/MultiB", 6).size() );
+    loader->prefetches.clear();
+    docs.prefetchDocuments = false;
+    docs.load<MultiA>(6);
+    EXPECT_TRUE(loader->prefetches.empty());
+}
+
+TEST_F( MultiTypeDocuments, timelineIsSameAsLoads ) {
+    const std::string doc3 = ::testing::TempDir() + "sdc-multi-4.txt";
+    {
+        std::ofstream ofs(doc3);
+        ofs << "runs=4-6" << std::endl << "type=TestData/MultiA" << std::endl
+            << "columns=a, b" << std::endl << "7 8" << std::endl;
+    }
+    ASSERT_TRUE(docs.add(doc3));
+    loader->nBlockReads = 0;
+    auto timeline = docs.load_timeline<MultiA>({0, 10});
+    // each block is read once
+    EXPECT_EQ(loader->nBlockReads, docs.validityIndex.entries().at("TestData/MultiA").size());
+    ASSERT_FALSE(timeline.empty());
+    EXPECT_EQ(timeline.back().first.to, 10);
+    EXPECT_EQ(timeline.size(), 5);  // starts at 1, 3, 4, 5 and 7 (expired)
+    for( int k = 0; k < 10; ++k ) {
+        auto ref = docs.load<MultiA>(k);
+        auto segIt = std::find_if( timeline.begin(), timeline.end()
+                , [k](const Documents<int>::Timeline<MultiA>::value_type & seg) {
+                    return seg.first.from <= k && k < seg.first.to;
+                } );
+        if( ref.empty() ) {
+            EXPECT_EQ(segIt, timeline.end()) << " for key " << k;
+            continue;
+        }
+        ASSERT_NE(segIt, timeline.end()) << " for key " << k;
+        const auto & col = *segIt->second;
+        ASSERT_EQ(col.size(), ref.size()) << " for key " << k;
+        for( size_t i = 0; i < ref.size(); ++i ) {
+            EXPECT_EQ(col[i].a, ref[i].a);
+            EXPECT_EQ(col[i].b, ref[i].b);
+            EXPECT_EQ(col[i].lineNo, ref[i].lineNo);
+        }
+    }
+    // segments are bound by change points only
+    for( size_t i = 1; i < timeline.size(); ++i ) {
+        EXPECT_NE(timeline[i].second->size(), 0);
+        EXPECT_TRUE(timeline[i-1].second != timeline[i].second);
+    }
+    // open range
+    auto open = docs.load_timeline<MultiA>({1, ValidityTraits<int>::unset});
+    ASSERT_FALSE(open.empty());
+    EXPECT_FALSE(ValidityTraits<int>::is_set(open.back().first.to));
+    EXPECT_EQ(open.back().second->size(), docs.load<MultiA>(100).size());
+    EXPECT_TRUE(docs.load_timeline<MultiA>({20, 30}).size() == 1);
+    remove(doc3.c_str());
+}
+
+TEST_F( MultiTypeDocuments, advanceIsSameAsLoad ) {
+    const std::string doc3 = ::testing::TempDir() + "sdc-multi-4.txt";
+    {
+        std::ofstream ofs(doc3);
+        ofs << "runs=4-6" << std::endl << "type=TestData/MultiA" << std::endl
+            << "columns=a, b" << std::endl << "7 8" << std::endl;
+    }
+    ASSERT_TRUE(docs.add(doc3));
+    EXPECT_FALSE(docs.validityIndex.expires("TestData/MultiA", 1, 6));
+    EXPECT_TRUE(docs.validityIndex.expires("TestData/MultiA", 4, 7));
+    EXPECT_FALSE(docs.validityIndex.expires("TestData/MultiA", 2, 7));  // not valid for 2
+    std::vector<MultiA> col;
+    int prev = ValidityTraits<int>::unset;
+    for( int k : {1, 2, 3, 4, 5, 6, 7, 8, 3, 9} ) {
+        loader->nBlockReads = 0;
+        const bool changed = docs.advance<MultiA>(col, prev, k);
+        const size_t nReads = loader->nBlockReads;
+        auto ref = docs.load<MultiA>(k);
+        ASSERT_EQ(col.size(), ref.size()) << " for key " << k;
+        for( size_t i = 0; i < ref.size(); ++i ) {
+            EXPECT_EQ(col[i].a, ref[i].a);
+            EXPECT_EQ(col[i].lineNo, ref[i].lineNo);
+        }
+        if( k == 2 || k == 6 || k == 8 ) {
+            // nothing changed
+            EXPECT_FALSE(changed) << " for key " << k;
+            EXPECT_EQ(nReads, 0) << " for key " << k;
+        } else if( k == 4 || k == 5 || k == 9 ) {
+            // one update added (for 3 -> 9 one at 4 has expired already)
+            EXPECT_TRUE(changed);
+            EXPECT_EQ(nReads, 1) << " for key " << k;
+        } else {
+            EXPECT_TRUE(changed);
+        }
+        prev = k;
+    }
+    remove(doc3.c_str());
+}
+
+TEST_F( MultiTypeDocuments, columnsSchemaIsSameAsInterpret ) {
+    for( int k : {1, 3, 6} ) {
+        auto ref = docs.load<MultiB>(k);
+        auto typed = docs.load<TypedB>(k);
+        ASSERT_EQ(typed.size(), ref.size());
+        for( size_t i = 0; i < ref.size(); ++i ) {
+            EXPECT_EQ(typed[i].label, ref[i].label);
+            EXPECT_EQ(typed[i].value, ref[i].value);
+            EXPECT_EQ(typed[i].extra, -1);
+            EXPECT_EQ(typed[i].lineNo, ref[i].lineNo);
+        }
+    }
+}
+
+TEST( ColumnsSchema, resolvesColumnsPerMetadataValue ) {
+    const auto & schema = CalibDataTraits<TypedB>::schema;
+    const std::string docID = "none";
+    aux::MetaInfo md;
+    md.set("columns", "extra, value, label", 1);
+    auto item = schema.parse("  12 1.5   foo ", RowContext{2, docID, md, nullptr});
+    EXPECT_EQ(item.label, "foo");
+    EXPECT_EQ(item.value, 1.5);
+    EXPECT_EQ(item.extra, 12);
+    // columns redefined
+    md.set("columns", "label, value", 3);
+    item = schema.parse("bar 2.5", RowContext{4, docID, md, nullptr});
+    EXPECT_EQ(item.label, "bar");
+    EXPECT_EQ(item.value, 2.5);
+    EXPECT_EQ(item.extra, -1);  // default
+    EXPECT_THROW( schema.parse("bar", RowContext{4, docID, md, nullptr})
+                , errors::ParserError );
+    // required column is not defined
+    aux::MetaInfo md2;
+    md2.set("columns", "value", 1);
+    EXPECT_THROW( schema.parse("2.5", RowContext{2, docID, md2, nullptr})
+                , errors::NoColumnDefinedForTable );
+    aux::MetaInfo md3;
+    EXPECT_THROW( schema.parse("2.5", RowContext{2, docID, md3, nullptr})
+                , errors::NoMetadataEntryInFile );
+}
+
+TEST( ColumnsSchema, checksAllColumnsAsInterpret ) {
+    const auto & schema = CalibDataTraits<TypedB>::schema;
+    const std::string docID = "none";
+    aux::MetaInfo md;
+    // column not declared by schema is missing in the row
+    md.set("columns", "label, value, comment", 1);
+    EXPECT_THROW( schema.parse("bar 2.5", RowContext{2, docID, md, nullptr})
+                , errors::ParserError );
+    EXPECT_THROW( md.get<aux::ColumnsOrder>("columns").interpret(aux::tokenize("bar 2.5"))
+                , errors::ParserError );
+    auto item = schema.parse("bar 2.5 any", RowContext{2, docID, md, nullptr});
+    EXPECT_EQ(item.label, "bar");
+    EXPECT_EQ(item.value, 2.5);
+}
+
+TEST( ColumnsSchema, resolutionsAreNotSharedBetweenInstances ) {
+    typedef typename std::decay<decltype(CalibDataTraits<TypedB>::schema)>::type Schema;
+    const std::string docID = "none";
+    aux::MetaInfo md;
+    md.set("columns", "label, value, extra", 1);
+    // schemas of same type created at the same address
+    std::optional<Schema> schema;
+    schema.emplace( aux::column("label", &TypedB::label)
+                  , aux::column("value", &TypedB::value, 0.f)
+                  , aux::column("extra", &TypedB::extra, -1) );
+    auto item = schema->parse("foo 1.5 3", RowContext{2, docID, md, nullptr});
+    EXPECT_EQ(item.label, "foo");
+    EXPECT_EQ(item.extra, 3);
+    schema.reset();
+    schema.emplace( aux::column("extra", &TypedB::label)
+                  , aux::column("value", &TypedB::value, 0.f)
+                  , aux::column("other", &TypedB::extra, -1) );
+    item = schema->parse("foo 1.5 3", RowContext{2, docID, md, nullptr});
+    EXPECT_EQ(item.label, "3");
+    EXPECT_EQ(item.extra, -1);
+}
+
+TEST_F( MultiTypeDocuments, blockCacheServesRepeatedLoads ) {
+    auto ref = docs.load<MultiA>(6);
+    docs.enable_block_cache(1024*1024);
+    ASSERT_TRUE(docs.blockCache);
+    loader->nBlockReads = 0;
+    auto first = docs.load<MultiA>(6);
+    EXPECT_EQ(loader->nBlockReads, 3);
+    EXPECT_EQ(docs.blockCache->n_misses(), 3);
+    EXPECT_EQ(docs.blockCache->n_hits(), 0);
+    EXPECT_EQ(docs.blockCache->n_entries(), 3);
+    // subsequent loads must not touch the documents
+    auto second = docs.load<MultiA>(7);
+    auto both = docs.load<MultiA, MultiB>(8);
+    EXPECT_EQ(loader->nBlockReads, 3);
+    EXPECT_EQ(loader->nMultiReads, 2);  // for MultiB blocks only
+    EXPECT_EQ(docs.blockCache->n_hits(), 6);
+    for( const auto * c : {&first, &second, &std::get<0>(both)} ) {
+        ASSERT_EQ(c->size(), ref.size());
+        for( size_t i = 0; i < ref.size(); ++i ) {
+            EXPECT_EQ((*c)[i].a, ref[i].a);
+            EXPECT_EQ((*c)[i].b, ref[i].b);
+            EXPECT_EQ((*c)[i].lineNo, ref[i].lineNo);
+        }
+    }
+}
+
+TEST_F( MultiTypeDocuments, blockCacheEvictsOverBudget ) {
+    docs.enable_block_cache(1);  // too small for any block
+    docs.load<MultiA>(6);
+    EXPECT_EQ(docs.blockCache->n_entries(), 0);
+    EXPECT_EQ(docs.blockCache->n_bytes(), 0);
+    docs.load<MultiA>(6);
+    EXPECT_EQ(docs.blockCache->n_hits(), 0);
+    EXPECT_EQ(docs.blockCache->n_misses(), 6);
+}
+
+TEST_F( MultiTypeDocuments, concurrentCachedLoadsAreConsistent ) {
+    const auto ref = docs.load<MultiA, MultiB>(6);
+    docs.enable_block_cache(1024*1024);
+    const Documents<int> & shared = docs;
+    std::vector<std::thread> threads;
+    std::vector<size_t> nMismatches(8, 0);
+    for( size_t n = 0; n < nMismatches.size(); ++n ) {
+        threads.emplace_back([&shared, &ref, &nMismatches, n](){
+            for( int i = 0; i < 20; ++i ) {
+                // mix of single, multi-type and cursor loads
+                auto as = shared.load<MultiA>(6);
+                auto both = shared.load<MultiA, MultiB>(6);
+                size_t nRows = 0;
+                for( const auto & row : shared.rows<MultiA>(6) ) {
+                    if( nRows >= as.size()
+                     || row.metainfo().get<size_t>("@lineNo") != as[nRows].lineNo )
+                        ++nMismatches[n];
+                    ++nRows;
+                }
+                if( nRows != as.size() ) ++nMismatches[n];
+                if( as.size() != std::get<0>(ref).size()
+                 || std::get<1>(both).size() != std::get<1>(ref).size() ) {
+                    ++nMismatches[n];
+                    continue;
+                }
+                for( size_t k = 0; k < as.size(); ++k ) {
+                    if( as[k].a != std::get<0>(ref)[k].a
+                     || as[k].lineNo != std::get<0>(ref)[k].lineNo
+                     || std::get<0>(both)[k].b != std::get<0>(ref)[k].b ) ++nMismatches[n];
+                }
+                for( size_t k = 0; k < std::get<1>(both).size(); ++k ) {
+                    if( std::get<1>(both)[k].label != std::get<1>(ref)[k].label )
+                        ++nMismatches[n];
+                }
+            }
+        });
+    }
+    for( auto & t : threads ) t.join();
+    for( size_t n = 0; n < nMismatches.size(); ++n )
+        EXPECT_EQ(0u, nMismatches[n]) << "thread #" << n;
+    EXPECT_GT(docs.blockCache->n_hits(), 0u);
+}
+
+TEST_F( MultiTypeDocuments, rowCursorYieldsRowsInUpdateOrder ) {
+    for( int k : {1, 3, 6} ) {
+        auto ref = docs.load<MultiA>(k);
+        auto c = docs.rows<MultiA>(k);
+        size_t n = 0;
+        while( c.next() ) {
+            ASSERT_LT(n, ref.size());
+            EXPECT_EQ(c.item().a, ref[n].a);
+            EXPECT_EQ(c.item().b, ref[n].b);
+            EXPECT_EQ(c.line_number(), ref[n].lineNo);
+            EXPECT_EQ(c.metainfo().get<size_t>("@lineNo"), ref[n].lineNo);
+            EXPECT_NE(c.doc_id().find("sdc-multi-"), std::string::npos);
+            ++n;
+        }
+        EXPECT_EQ(n, ref.size());
+        EXPECT_FALSE(c.next());
+    }
+    // range-based for, terminated early; documents are read on demand
+    loader->nBlockReads = 0;
+    std::string foundIn;
+    for( const auto & row : docs.rows<MultiB>(6) ) {
+        if( row.item().label == "two" ) {
+            foundIn = row.doc_id();
+            EXPECT_EQ(row.line_number(), 5);
+            break;
+        }
+    }
+    EXPECT_NE(foundIn.find("sdc-multi-2.txt"), std::string::npos);
+    EXPECT_EQ(loader->nBlockReads, 0);
+}
+
+TEST_F( MultiTypeDocuments, rowCursorBeginIsIdempotent ) {
+    auto ref = docs.load<MultiA>(6);
+    ASSERT_GT(ref.size(), 1);
+    auto c = docs.rows<MultiA>(6);
+    auto it = c.begin();
+    ASSERT_NE(it, c.end());
+    EXPECT_EQ(it->line_number(), ref[0].lineNo);
+    // repeated begin() does not advance the cursor
+    it = c.begin();
+    ASSERT_NE(it, c.end());
+    EXPECT_EQ(it->line_number(), ref[0].lineNo);
+    ++it;
+    EXPECT_EQ(c.begin()->line_number(), ref[1].lineNo);
+    // exhausted cursor has no rows to iterate over
+    while( c.next() ) {}
+    EXPECT_EQ(c.begin(), c.end());
+}
+
+TEST_F( MultiTypeDocuments, rowCursorUsesBlockCache ) {
+    docs.enable_block_cache(1024*1024);
+    auto ref = docs.load<MultiA>(6);
+    size_t n = 0;
+    for( const auto & row : docs.rows<MultiA>(6) ) {
+        ASSERT_LT(n, ref.size());
+        EXPECT_EQ(row.item().a, ref[n].a);
+        EXPECT_EQ(row.line_number(), ref[n].lineNo);
+        ++n;
+    }
+    EXPECT_EQ(n, ref.size());
+    EXPECT_EQ(docs.blockCache->n_hits(), 3);
+}
+
+/// Loader type not used by documents, to check fallback
+struct OtherLoader : public ExtCSVLoader<int> {};
+
+TEST_F( MultiTypeDocuments, staticLoadIsSameAsPolymorphic ) {
+    for( int k : {1, 3, 6} ) {
+        auto ref = docs.load<MultiB>(k);
+        loader->nBlockReads = 0;
+        auto bs = docs.load_static<MultiB, CountingLoader>(k);
+        EXPECT_EQ(loader->nBlockReads, 0);  // virtual method not used
+        ASSERT_EQ(bs.size(), ref.size());
+        for( size_t i = 0; i < ref.size(); ++i ) {
+            EXPECT_EQ(bs[i].label, ref[i].label);
+            EXPECT_EQ(bs[i].value, ref[i].value);
+            EXPECT_EQ(bs[i].lineNo, ref[i].lineNo);
+        }
+        // fallback to polymorphic reading
+        const size_t nUpdates = docs.validityIndex.updates("TestData/MultiB", k).size();
+        auto bs2 = docs.load_static<MultiB, OtherLoader>(k);
+        EXPECT_EQ(bs2.size(), ref.size());
+        EXPECT_EQ(loader->nBlockReads, nUpdates);
+        // subclass of the static loader type overrides reading methods, so
+        // it is read polymorphically as well
+        auto bs3 = docs.load_static<MultiB, ExtCSVLoader<int>>(k);
+        EXPECT_EQ(bs3.size(), ref.size());
+        EXPECT_EQ(loader->nBlockReads, 2*nUpdates);
+    }
+}
+
+TEST_F( MultiTypeDocuments, structureCacheSkipsPreparsing ) {
+    const std::string docIDs[] = { ::testing::TempDir() + "sdc-multi-1.txt"
+                                 , ::testing::TempDir() + "sdc-multi-2.txt"
+                                 };
+    const std::string idxDir = ::testing::TempDir();
+    auto index = [&]( Documents<int> & cDocs, std::shared_ptr<CountingLoader> & l ) {
+        l = std::make_shared<CountingLoader>();
+        cDocs.loaders.push_back(l);
+        cDocs.enable_structure_cache(idxDir);
+        for( const auto & docID : docIDs ) {
+            remove(cDocs.structureCache->path_for(docID).c_str());
+        }
+    };
+    std::shared_ptr<CountingLoader> l1, l2;
+    Documents<int> docs1, docs2;
+    index(docs1, l1);
+    for( const auto & docID : docIDs ) ASSERT_TRUE(docs1.add(docID));
+    EXPECT_EQ(l1->nStructReads, 2);
+    EXPECT_EQ(docs1.structureCache->n_misses(), 2);
+    // second index is built from cache
+    l2 = std::make_shared<CountingLoader>();
+    docs2.loaders.push_back(l2);
+    docs2.enable_structure_cache(idxDir);
+    for( const auto & docID : docIDs ) ASSERT_TRUE(docs2.add(docID));
+    EXPECT_EQ(l2->nStructReads, 0);
+    EXPECT_EQ(docs2.structureCache->n_hits(), 2);
+    for( int k : {1, 3, 6} ) {
+        auto ref = docs.load<MultiA, MultiB>(k);
+        auto cached = docs2.load<MultiA, MultiB>(k);
+        ASSERT_EQ(std::get<0>(cached).size(), std::get<0>(ref).size());
+        for( size_t i = 0; i < std::get<0>(ref).size(); ++i ) {
+            EXPECT_EQ(std::get<0>(cached)[i].a, std::get<0>(ref)[i].a);
+            EXPECT_EQ(std::get<0>(cached)[i].lineNo, std::get<0>(ref)[i].lineNo);
+        }
+        ASSERT_EQ(std::get<1>(cached).size(), std::get<1>(ref).size());
+        for( size_t i = 0; i < std::get<1>(ref).size(); ++i ) {
+            EXPECT_EQ(std::get<1>(cached)[i].label, std::get<1>(ref)[i].label);
+        }
+    }
+    // touched document is validated by content hash
+    {
+        struct timespec ts[2] = {{0, UTIME_NOW}, {1000, 0}};
+        ASSERT_EQ(utimensat(AT_FDCWD, docIDs[0].c_str(), ts, 0), 0);
+    }
+    Documents<int> docs3;
+    docs3.loaders.push_back(l2);
+    docs3.enable_structure_cache(idxDir);
+    ASSERT_TRUE(docs3.add(docIDs[0]));
+    EXPECT_EQ(l2->nStructReads, 0);
+    EXPECT_EQ(docs3.structureCache->n_hits(), 1);
+    // changed document is re-parsed
+    {
+        std::ofstream ofs(docIDs[0], std::ios::app);
+        ofs << std::endl << "runs=7-..." << std::endl << "11 12" << std::endl;
+    }
+    Documents<int> docs4;
+    docs4.loaders.push_back(l2);
+    docs4.enable_structure_cache(idxDir);
+    ASSERT_TRUE(docs4.add(docIDs[0]));
+    EXPECT_EQ(l2->nStructReads, 1);
+    EXPECT_EQ(docs4.structureCache->n_stale(), 1);
+    EXPECT_EQ(docs4.load<MultiA>(7).back().a, 11);
+    // ...once
+    Documents<int> docs5;
+    docs5.loaders.push_back(l2);
+    docs5.enable_structure_cache(idxDir);
+    ASSERT_TRUE(docs5.add(docIDs[0]));
+    EXPECT_EQ(l2->nStructReads, 1);
+    // different defaults invalidate the cache
+    ASSERT_TRUE(docs5.add(docIDs[1], {true, "TestData/MultiA"}));
+    EXPECT_EQ(l2->nStructReads, 2);
+    EXPECT_EQ(docs5.structureCache->n_stale(), 1);
+    // read-only cache file is used, even for touched document
+    {
+        const std::string cachePath = docs5.structureCache->path_for(docIDs[0]);
+        ASSERT_EQ(chmod(cachePath.c_str(), S_IRUSR), 0);
+        struct timespec ts[2] = {{0, UTIME_NOW}, {2000, 0}};
+        ASSERT_EQ(utimensat(AT_FDCWD, docIDs[0].c_str(), ts, 0), 0);
+        Documents<int> docs6;
+        docs6.loaders.push_back(l2);
+        docs6.enable_structure_cache(idxDir);
+        ASSERT_TRUE(docs6.add(docIDs[0]));
+        EXPECT_EQ(l2->nStructReads, 2);
+        EXPECT_EQ(docs6.structureCache->n_hits(), 1);
+        chmod(cachePath.c_str(), S_IRUSR | S_IWUSR);
+    }
+    for( const auto & docID : docIDs ) {
+        remove(docs5.structureCache->path_for(docID).c_str());
+    }
+}
+
+TEST_F( MultiTypeDocuments, snapshotRestoresIndex ) {
+    const std::string snPath = ::testing::TempDir() + "sdc-multi.sdcsnp"
+                    , docID = ::testing::TempDir() + "sdc-multi-1.txt"
+                    ;
+    docs.save_snapshot(snPath);
+    auto l = std::make_shared<CountingLoader>();
+    Documents<int> restored;
+    restored.loaders.push_back(l);
+    ASSERT_TRUE(restored.restore_snapshot(snPath));
+    EXPECT_EQ(l->nStructReads, 0);
+    for( int k : {1, 3, 6} ) {
+        auto ref = docs.load<MultiA, MultiB>(k);
+        auto rs = restored.load<MultiA, MultiB>(k);
+        ASSERT_EQ(std::get<0>(rs).size(), std::get<0>(ref).size());
+        for( size_t i = 0; i < std::get<0>(ref).size(); ++i ) {
+            EXPECT_EQ(std::get<0>(rs)[i].a, std::get<0>(ref)[i].a);
+            EXPECT_EQ(std::get<0>(rs)[i].lineNo, std::get<0>(ref)[i].lineNo);
+        }
+        ASSERT_EQ(std::get<1>(rs).size(), std::get<1>(ref).size());
+        for( size_t i = 0; i < std::get<1>(ref).size(); ++i ) {
+            EXPECT_EQ(std::get<1>(rs)[i].label, std::get<1>(ref)[i].label);
+        }
+    }
+    // changed document is re-indexed, others are not
+    {
+        std::ofstream ofs(docID, std::ios::app);
+        ofs << std::endl << "runs=7-..." << std::endl << "11 12" << std::endl;
+    }
+    Documents<int> restored2;
+    restored2.loaders.push_back(l);
+    ASSERT_TRUE(restored2.restore_snapshot(snPath));
+    EXPECT_EQ(l->nStructReads, 1);
+    EXPECT_EQ(restored2.load<MultiA>(7).back().a, 11);
+    EXPECT_EQ(restored2.load<MultiB>(6).size(), docs.load<MultiB>(6).size());
+    // vanished document is removed from index
+    remove(docID.c_str());
+    Documents<int> restored3;
+    restored3.loaders.push_back(l);
+    ASSERT_TRUE(restored3.restore_snapshot(snPath));
+    EXPECT_EQ(l->nStructReads, 1);
+    for( const auto & typeEntry : restored3.validityIndex.entries() ) {
+        for( const auto & p : typeEntry.second )
+            EXPECT_NE(p.second.docID, docID);
+    }
+    // different loaders are refused
+    Documents<int> other;
+    other.loaders.push_back(std::make_shared<OtherLoader>());
+    EXPECT_FALSE(other.restore_snapshot(snPath));
+    EXPECT_TRUE(other.validityIndex.entries().empty());
+    EXPECT_FALSE(other.restore_snapshot(snPath + ".none"));
+    remove(snPath.c_str());
+}
+
+/// Empty user info for validity index tests
+struct NoAuxInfo {};
+
+TEST( ValidityIndex, updatesAreSameAsFullScan ) {
+    ValidityIndex<int, NoAuxInfo> index;
+    // reference: scan of all the entries in index order, omitting stale ones
+    auto scan = [&](const aux::Atom & type, int key) {
+        ValidityIndex<int, NoAuxInfo>::Updates us;
+        for( const auto & p : index.entries().at(type) ) {
+            if( key < p.first ) break;
+            if( p.second.validTo && p.second.validTo <= key ) continue;
+            us.emplace_back(p.first, &p.second);
+        }
+        return us;
+    };
+    auto check = [&](const aux::Atom & type) {
+        for( int key = 1; key < 1100; key += 7 ) {
+            EXPECT_EQ(index.updates(type, key), scan(type, key)) << "key " << key;
+        }
+    };
+    unsigned int seed = 1234;
+    auto next = [&seed](unsigned int n) {
+        seed = seed*1103515245u + 12345u;
+        return int((seed >> 16) % n);
+    };
+    // short, long, open-ended and duplicating ranges
+    for( int i = 0; i < 500; ++i ) {
+        const int from = 1 + next(1000)
+                , to = (i % 5) ? from + 1 + next(i % 3 ? 20 : 400) : 0
+                ;
+        index.add_entry( "doc" + std::to_string(i % 50), "T", from, to, NoAuxInfo{} );
+        if( i % 100 == 99 ) check("T");
+    }
+    index.add_entry( "docX", "T", 500, 0, NoAuxInfo{} );
+    index.add_entry( "docX", "T", 500, 501, NoAuxInfo{} );
+    check("T");
+    // index is updated on removal
+    EXPECT_GT(index.remove_document("doc7"), 0);
+    EXPECT_GT(index.remove_document("docX"), 0);
+    check("T");
+    // copy has own index
+    ValidityIndex<int, NoAuxInfo> copy(index);
+    index.add_entry( "docY", "T", 1, 0, NoAuxInfo{} );
+    EXPECT_EQ(copy.updates("T", 1000).size() + 1, index.updates("T", 1000).size());
+    check("T");
+}
+
+TEST( ValidityIndex, concurrentQueriesAreConsistent ) {
+    ValidityIndex<int, NoAuxInfo> index;
+    for( int i = 0; i < 2000; ++i ) {
+        index.add_entry( "doc" + std::to_string(i % 50), i % 2 ? "T1" : "T2"
+                       , 1 + i/2, (i % 3) ? 10 + i/2 : 0, NoAuxInfo{} );
+    }
+    // reference results by a copy (which has own cover indexes)
+    const ValidityIndex<int, NoAuxInfo> ref(index);
+    const ValidityIndex<int, NoAuxInfo> & shared = index;
+    std::vector<std::thread> threads;
+    std::vector<size_t> nMismatches(8, 0);
+    for( size_t n = 0; n < nMismatches.size(); ++n ) {
+        threads.emplace_back([&shared, &ref, &nMismatches, n](){
+            for( int key = 1; key < 1100; key += 13 ) {
+                for( const char * type : {"T1", "T2"} ) {
+                    auto us = shared.updates(type, key + int(n));
+                    // entries must be the same, addresses differ in copy
+                    auto refUs = ref.updates(type, key + int(n));
+                    if( us.size() != refUs.size() ) { ++nMismatches[n]; continue; }
+                    auto it = refUs.begin();
+                    for( const auto & u : us ) {
+                        if( u.first != it->first
+                         || u.second->docID != it->second->docID
+                         || u.second->validTo != it->second->validTo ) ++nMismatches[n];
+                        ++it;
+                    }
+                }
+            }
+        });
+    }
+    for( auto & t : threads ) t.join();
+    for( size_t n = 0; n < nMismatches.size(); ++n )
+        EXPECT_EQ(0u, nMismatches[n]) << "thread #" << n;
+}
+
+TEST( DocumentsWatcher, appliesChangesToIndex ) {
+    for( bool useINotify : {true, false} ) {
+        const std::string dir = ::testing::TempDir() + "sdc-watch/"
+                        , doc1 = dir + "one.txt"
+                        , doc2 = dir + "sub/two.txt"
+                        ;
+        mkdir(dir.c_str(), 0755);
+        {
+            std::ofstream ofs(doc1);
+            ofs << tstMultiDoc1;
+        }
+        auto l = std::make_shared<CountingLoader>();
+        Documents<int> docs;
+        docs.loaders.push_back(l);
+        {
+            aux::FS fs(dir, "*.txt", "", 10, 1024*1024);
+            ASSERT_EQ(docs.add_from(fs), 1);
+        }
+        DocumentsWatcher<int> watcher(docs, dir, "*.txt", "", 10, 1024*1024, useINotify);
+        EXPECT_EQ(watcher.uses_inotify(), useINotify && !SDC_NO_INOTIFY);
+        EXPECT_TRUE(watcher.poll().empty());
+        EXPECT_EQ(l->nStructReads, 1);
+        const size_t nBs = docs.load<MultiB>(6).size();
+        // new document in new subdirectory
+        mkdir((dir + "sub").c_str(), 0755);
+        {
+            std::ofstream ofs(doc2);
+            ofs << tstMultiDoc2;
+        }
+        auto changes = watcher.poll();
+        ASSERT_EQ(changes.added.size(), 1);
+        EXPECT_EQ(changes.added[0], doc2);
+        EXPECT_TRUE(changes.updated.empty());
+        EXPECT_EQ(l->nStructReads, 2);
+        EXPECT_EQ(docs.load<MultiB>(6).size(), 3);
+        // changed document is re-indexed, other is not
+        const size_t gen = docs.generation("TestData/MultiA");
+        {
+            std::ofstream ofs(doc1, std::ios::app);
+            ofs << std::endl << "runs=7-..." << std::endl << "11 12" << std::endl;
+        }
+        changes = watcher.poll();
+        ASSERT_EQ(changes.updated.size(), 1);
+        EXPECT_EQ(changes.updated[0], doc1);
+        EXPECT_EQ(l->nStructReads, 3);
+        EXPECT_NE(docs.generation("TestData/MultiA"), gen);
+        EXPECT_EQ(docs.load<MultiA>(7).back().a, 11);
+        EXPECT_EQ(docs.load<MultiB>(6).size(), 3);
+        // removed document is dropped
+        remove(doc2.c_str());
+        changes = watcher.poll();
+        ASSERT_EQ(changes.removed.size(), 1);
+        EXPECT_EQ(changes.removed[0], doc2);
+        EXPECT_EQ(docs.load<MultiB>(6).size(), nBs);
+        EXPECT_TRUE(watcher.poll().empty());
+        remove(doc1.c_str());
+        rmdir((dir + "sub").c_str());
+        rmdir(dir.c_str());
+    }
+}
+
+/// Loader failing on certain documents with non-library exceptions
+struct FailingLoader : public CountingLoader {
+    /// Document to fail with `std::exception` subclass
+    std::string badDocID;
+    /// Document to fail (once) with exception not derived from `std::exception`
+    std::string interruptingDocID;
+    std::list<Documents<int>::DataBlock>
+    get_doc_struct( const std::string & docID ) override {
+        if( docID == badDocID ) throw std::invalid_argument("bad document");
+        if( docID == interruptingDocID ) {
+            interruptingDocID.clear();
+            throw 42;
+        }
+        return CountingLoader::get_doc_struct(docID);
+    }
+};
+
+TEST( DocumentsWatcher, recoversFromIndexingErrors ) {
+    for( bool useINotify : {true, false} ) {
+        const std::string dir = ::testing::TempDir() + "sdc-watch-err/"
+                        , doc1 = dir + "one.txt"
+                        , doc2 = dir + "two.txt"
+                        ;
+        mkdir(dir.c_str(), 0755);
+        auto l = std::make_shared<FailingLoader>();
+        l->badDocID = doc1;
+        Documents<int> docs;
+        docs.loaders.push_back(l);
+        DocumentsWatcher<int> watcher(docs, dir, "*.txt", "", 10, 1024*1024, useINotify);
+        EXPECT_TRUE(watcher.poll().empty());
+        {
+            std::ofstream ofs(doc1);
+            ofs << tstMultiDoc1;
+        }
+        {
+            std::ofstream ofs(doc2);
+            ofs << tstMultiDoc2;
+        }
+        // error of one document does not affect the other
+        auto changes = watcher.poll();
+        EXPECT_EQ(changes.nErrors, 1);
+        ASSERT_EQ(changes.added.size(), 1);
+        EXPECT_EQ(changes.added[0], doc2);
+        // interrupted poll does not lose the change
+        l->badDocID.clear();
+        l->interruptingDocID = doc1;
+        {
+            std::ofstream ofs(doc1, std::ios::app);
+            ofs << std::endl << "runs=7-..." << std::endl << "11 12" << std::endl;
+        }
+        EXPECT_THROW(watcher.poll(), int);
+        changes = watcher.poll();
+        EXPECT_EQ(changes.nErrors, 0);
+        ASSERT_EQ(changes.updated.size(), 1);  // known (failed) before
+        EXPECT_EQ(changes.updated[0], doc1);
+        EXPECT_EQ(docs.load<MultiA>(7).back().a, 11);
+        EXPECT_TRUE(watcher.poll().empty());
+        remove(doc1.c_str());
+        remove(doc2.c_str());
+        rmdir(dir.c_str());
+    }
+}
+
+//
+// Binary container
+
+/// Document with metadata changed within a block
+static const char tstMultiDoc3[] = R"TST(# third document
+runs=2-...
+type=TestData/MultiA
+columns=a, b
+7 8
+columns=b, a
+10 9
+)TST";
+
+TEST_F( MultiTypeDocuments, binaryContainerIsSameAsText ) {
+    const std::string doc3 = ::testing::TempDir() + "sdc-multi-3.txt"
+                    , binPath = ::testing::TempDir() + "sdc-multi.sdcbin"
+                    ;
+    {
+        std::ofstream ofs(doc3);
+        ofs << tstMultiDoc3;
+    }
+    ASSERT_TRUE(docs.add(doc3));
+    const std::vector<std::string> docIDs = {
+              ::testing::TempDir() + "sdc-multi-1.txt"
+            , ::testing::TempDir() + "sdc-multi-2.txt"
+            , doc3
+        };
+    ExtCSVLoader<int> csvLoader;
+    EXPECT_EQ(compile_binary<int>(csvLoader, docIDs, binPath), 6);
+
+    Documents<int> binDocs;
+    auto binLoader = std::make_shared<BinaryLoader<int>>(binPath);
+    binDocs.loaders.push_back(binLoader);
+    ASSERT_EQ(binLoader->doc_ids(), docIDs);
+    for( const auto & docID : binLoader->doc_ids() ) {
+        ASSERT_TRUE(binDocs.add(docID));
+    }
+    for( int k : {1, 2, 3, 6} ) {
+        auto ref = docs.load<MultiA, MultiB>(k);
+        auto bin = binDocs.load<MultiA, MultiB>(k);
+        const auto binBs = binDocs.load_static<MultiB, BinaryLoader<int>>(k);
+        const auto & refAs = std::get<0>(ref), & binAs = std::get<0>(bin);
+        const auto & refBs = std::get<1>(ref), & binBs2 = std::get<1>(bin);
+        ASSERT_EQ(binAs.size(), refAs.size()) << " for key " << k;
+        for( size_t i = 0; i < refAs.size(); ++i ) {
+            EXPECT_EQ(binAs[i].a, refAs[i].a);
+            EXPECT_EQ(binAs[i].b, refAs[i].b);
+            EXPECT_EQ(binAs[i].lineNo, refAs[i].lineNo);
+        }
+        for( const auto * bs : {&binBs, &binBs2} ) {
+            ASSERT_EQ(bs->size(), refBs.size()) << " for key " << k;
+            for( size_t i = 0; i < refBs.size(); ++i ) {
+                EXPECT_EQ((*bs)[i].label, refBs[i].label);
+                EXPECT_EQ((*bs)[i].value, refBs[i].value);
+                EXPECT_EQ((*bs)[i].lineNo, refBs[i].lineNo);
+            }
+        }
+        size_t n = 0;
+        for( const auto & row : binDocs.rows<MultiA>(k) ) {
+            ASSERT_LT(n, refAs.size());
+            EXPECT_EQ(row.item().a, refAs[n].a);
+            EXPECT_EQ(row.line_number(), refAs[n].lineNo);
+            EXPECT_EQ(row.doc_id().find(::testing::TempDir()), 0);
+            ++n;
+        }
+        EXPECT_EQ(n, refAs.size());
+    }
+    // metadata change within the block is respected
+    auto as = binDocs.load<MultiA>(2);
+    ASSERT_EQ(as.size(), 4);
+    EXPECT_EQ(as[2].a, 7);  EXPECT_EQ(as[2].b, 8);
+    EXPECT_EQ(as[3].a, 9);  EXPECT_EQ(as[3].b, 10);
+    // not a container
+    EXPECT_THROW(BinaryLoader<int> l(doc3), errors::IOError);
+    remove(doc3.c_str());
+    remove(binPath.c_str());
+}
+
+//
+// Compressed documents
+
+/// Generates large document of many blocks with pseudo-random content
+static std::string
+generate_large_document( size_t nBlocks, size_t nRows ) {
+    std::ostringstream oss;
+    oss << "type=TestData/MultiA" << std::endl
+        << "columns=a, b" << std::endl;
+    unsigned int r = 42;
+    for( size_t nBlock = 0; nBlock < nBlocks; ++nBlock ) {
+        oss << std::endl << "runs=" << nBlock*10 << "-" << nBlock*10 + 9 << std::endl;
+        for( size_t nRow = 0; nRow < nRows; ++nRow ) {
+            r = r*1103515245 + 12345;
+            oss << nBlock << " " << ((r >> 8) % 100000) << std::endl;
+        }
+    }
+    return oss.str();
+}
+
+class CompressedDocuments : public ::testing::Test {
+protected:
+    std::string _content
+              , _dir
+              ;
+
+    /// Creates documents index with single document and ExtCSV loader
+    /// collecting restart points rather frequently
+    void _index( Documents<int> & docs, const std::string & path ) {
+        auto loader = std::make_shared<ExtCSVLoader<int>>();
+        loader->restartPointsSpan = 16*1024;
+        docs.loaders.push_back(loader);
+        ASSERT_TRUE(docs.add(path));
+    }
+
+    void SetUp() override {
+        _content = generate_large_document(400, 100);
+        _dir = ::testing::TempDir() + "sdc-compressed/";
+        mkdir(_dir.c_str(), 0755);
+        std::ofstream ofs(_dir + "plain.dat");
+        ofs << _content;
+    }
+
+    /// Checks that loaded data and block structure matches the plain one
+    void _check_same_as_plain( const std::string & path ) {
+        Documents<int> plain, compressed;
+        _index(plain, _dir + "plain.dat");
+        _index(compressed, path);
+        for( int k : {0, 5, 1234, 2007, 3999} ) {
+            auto ref = plain.load<MultiA>(k);
+            ASSERT_EQ(ref.size(), 100) << " for key " << k;
+            auto as = compressed.load<MultiA>(k);
+            auto as2 = compressed.load_static<MultiA, ExtCSVLoader<int>>(k);
+            ASSERT_EQ(as.size(), ref.size()) << " for key " << k;
+            ASSERT_EQ(as2.size(), ref.size()) << " for key " << k;
+            size_t n = 0;
+            for( const auto & row : compressed.rows<MultiA>(k) ) {
+                ASSERT_LT(n, ref.size());
+                EXPECT_EQ(row.item().b, ref[n].b);
+                EXPECT_EQ(row.line_number(), ref[n].lineNo);
+                ++n;
+            }
+            EXPECT_EQ(n, ref.size());
+            for( size_t i = 0; i < ref.size(); ++i ) {
+                EXPECT_EQ(as[i].a, ref[i].a);
+                EXPECT_EQ(as[i].b, ref[i].b);
+                EXPECT_EQ(as[i].lineNo, ref[i].lineNo);
+                EXPECT_EQ(as2[i].b, ref[i].b);
+            }
+        }
+    }
+};
+
+TEST( DecompressedCache, evictsAndValidatesEntries ) {
+    const std::string path = ::testing::TempDir() + "sdc-decompressed-cache.txt";
+    {
+        std::ofstream ofs(path);
+        ofs << "content";
+    }
+    struct stat st;
+    ASSERT_EQ(stat(path.c_str(), &st), 0);
+    aux::DecompressedCache cache(100);
+    EXPECT_FALSE(cache.get(path, st));
+    cache.put(path, st, std::make_shared<const std::string>(60, 'a'));
+    ASSERT_TRUE(cache.get(path, st));
+    EXPECT_EQ(cache.get(path, st)->size(), 60);
+    // entry is dropped when file changes
+    struct stat changed = st;
+    changed.st_mtim.tv_nsec = (st.st_mtim.tv_nsec + 1) % 1000000000;
+    EXPECT_FALSE(cache.get(path, changed));
+    EXPECT_EQ(cache.n_bytes(), 0);
+    // least recently used entry is evicted on budget excess
+    cache.put(path, st, std::make_shared<const std::string>(60, 'a'));
+    cache.put(path + "2", st, std::make_shared<const std::string>(60, 'b'));
+    EXPECT_FALSE(cache.get(path, st));
+    ASSERT_TRUE(cache.get(path + "2", st));
+    EXPECT_EQ(cache.n_bytes(), 60);
+    // content exceeding the budget is not kept
+    cache.put(path, st, std::make_shared<const std::string>(200, 'c'));
+    EXPECT_FALSE(cache.get(path, st));
+    cache.set_budget(0);
+    EXPECT_EQ(cache.n_bytes(), 0);
+    remove(path.c_str());
+}
+
+TEST_F( CompressedDocuments, plainDocumentIsMapped ) {
+    aux::MappedDocument doc(_dir + "plain.dat", nullptr, 1024);
+    EXPECT_EQ(doc.compression(), aux::MappedDocument::kPlain);
+    EXPECT_EQ(doc.content(), _content);
+    EXPECT_TRUE(doc.restart_points().empty());
+}
+
+#ifndef SDC_NO_ZLIB
+TEST_F( CompressedDocuments, gzipDocumentIsReadAsPlain ) {
+    const std::string path = _dir + "doc.txt.gz";
+    gzFile gzf = gzopen(path.c_str(), "wb");
+    ASSERT_TRUE(gzf);
+    // write as two gzip members
+    const size_t half = _content.size()/2;
+    ASSERT_EQ(gzwrite(gzf, _content.data(), half), (int) half);
+    gzclose(gzf);
+    gzf = gzopen(path.c_str(), "ab");
+    ASSERT_EQ( gzwrite(gzf, _content.data() + half, _content.size() - half)
+             , (int) (_content.size() - half) );
+    gzclose(gzf);
+
+    aux::MappedDocument doc(path, nullptr, 16*1024);
+    EXPECT_EQ(doc.compression(), aux::MappedDocument::kGzip);
+    ASSERT_EQ(doc.content(), _content);
+    ASSERT_GT(doc.restart_points().size(), 4);
+    // decompression from restart point yields the document's tail
+    for( const auto & rp : doc.restart_points() ) {
+        aux::MappedDocument tail(path, rp.get());
+        EXPECT_EQ(tail.base_offset(), rp->offset);
+        EXPECT_EQ(tail.content(), std::string_view(_content).substr(rp->offset));
+    }
+    // blocks refer to restart points
+    ExtCSVLoader<int> loader;
+    loader.restartPointsSpan = 16*1024;
+    size_t nWithRP = 0;
+    for( const auto & block : loader.get_doc_struct(path) ) {
+        if( !block.restartPoint ) continue;
+        EXPECT_LE(block.restartPoint->offset, block.blockOffset);
+        ++nWithRP;
+    }
+    EXPECT_GT(nWithRP, 300);
+
+    _check_same_as_plain(path);
+
+    // discovered by default FS patterns
+    auto as = load_from_fs<int, MultiA>(_dir, 2007);
+    EXPECT_EQ(as.size(), 200);  // plain and compressed documents
+    remove(path.c_str());
+}
+
+TEST_F( CompressedDocuments, truncatedGzipDocumentIsAnError ) {
+    const std::string path = _dir + "truncated.txt.gz";
+    gzFile gzf = gzopen(path.c_str(), "wb");
+    ASSERT_TRUE(gzf);
+    gzwrite(gzf, _content.data(), _content.size());
+    gzclose(gzf);
+    ASSERT_EQ(truncate(path.c_str(), 1024), 0);
+    EXPECT_THROW(aux::MappedDocument doc(path), errors::IOError);
+    remove(path.c_str());
+}
+#endif
+
+#ifndef SDC_NO_LZMA
+TEST_F( CompressedDocuments, xzDocumentIsReadAsPlain ) {
+    const std::string path = _dir + "doc.txt.xz";
+    std::string compressed(lzma_stream_buffer_bound(_content.size()), '\0');
+    size_t outPos = 0;
+    ASSERT_EQ( lzma_easy_buffer_encode( 6, LZMA_CHECK_CRC64, nullptr
+                                      , reinterpret_cast<const uint8_t *>(_content.data())
+                                      , _content.size()
+                                      , reinterpret_cast<uint8_t *>(&compressed[0])
+                                      , &outPos, compressed.size() )
+             , LZMA_OK );
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(compressed.data(), outPos);
+    }
+    aux::MappedDocument doc(path);
+    EXPECT_EQ(doc.compression(), aux::MappedDocument::kXz);
+    EXPECT_EQ(doc.content(), _content);
+
+    _check_same_as_plain(path);
+    remove(path.c_str());
+}
+#endif
+
+#ifndef SDC_NO_ZSTD
+TEST_F( CompressedDocuments, zstdDocumentIsReadAsPlain ) {
+    const std::string path = _dir + "doc.txt.zst";
+    // write as two zstd frames
+    const size_t half = _content.size()/2;
+    std::string compressed;
+    for( std::string_view part : { std::string_view(_content).substr(0, half)
+                                 , std::string_view(_content).substr(half) } ) {
+        std::string frame(ZSTD_compressBound(part.size()), '\0');
+        const size_t n = ZSTD_compress( &frame[0], frame.size()
+                                      , part.data(), part.size(), 3 );
+        ASSERT_FALSE(ZSTD_isError(n));
+        compressed.append(frame.data(), n);
+    }
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(compressed.data(), compressed.size());
+    }
+    aux::MappedDocument doc(path);
+    EXPECT_EQ(doc.compression(), aux::MappedDocument::kZstd);
+    EXPECT_EQ(doc.content(), _content);
+
+    // decompressed content is re-used while file is not changed
+    auto & cache = aux::DecompressedCache::instance();
+    const size_t nHits = cache.n_hits();
+    {
+        aux::MappedDocument again(path);
+        EXPECT_EQ(again.compression(), aux::MappedDocument::kZstd);
+        EXPECT_EQ(again.content(), _content);
+        EXPECT_EQ(again.content().data(), doc.content().data());
+    }
+    EXPECT_EQ(cache.n_hits(), nHits + 1);
+
+    _check_same_as_plain(path);
+
+    // discovered by default FS patterns
+    auto as = load_from_fs<int, MultiA>(_dir, 2007);
+    EXPECT_EQ(as.size(), 200);  // plain and compressed documents
+
+    // truncated document is an error
+    ASSERT_EQ(truncate(path.c_str(), compressed.size()/3), 0);
+    EXPECT_THROW(aux::MappedDocument truncated(path), errors::IOError);
+    remove(path.c_str());
+}
+#endif
+
+}  // namespace ::sdc::test
+}  // namespace sdc
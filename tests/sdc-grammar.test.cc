@@ -124,6 +124,67 @@ TEST( ExtCSVLoader, SDCDefaultParsingValid ) {
             } );
 }
 
+TEST( ExtCSVLoader, preparsingRecordsBlockOffsets ) {
+    ExtCSVLoader<int> l;
+
+    std::istringstream iss(tstSDCTest1);
+    auto m = l.get_doc_struct(iss);
+    ASSERT_EQ(m.size(), 2);
+    const std::string doc(tstSDCTest1);
+    auto it = m.begin();
+    ASSERT_TRUE(it->mdSnapshot);
+    EXPECT_EQ(it->blockBgn, 6);
+    EXPECT_EQ(doc.substr(it->blockOffset, 8), "1   4.56");
+    EXPECT_EQ(it->mdSnapshot->get<std::string>("columns"), "b, c");
+    EXPECT_EQ(it->mdSnapshot->get<std::string>("type"), "TestType1");
+    auto first = it->mdSnapshot;
+    ++it;
+    ASSERT_TRUE(it->mdSnapshot);
+    EXPECT_NE(it->mdSnapshot, first);
+    EXPECT_EQ(it->blockBgn, 16);
+    EXPECT_EQ(doc.substr(it->blockOffset, 16), "1   4.56    0.12");
+    EXPECT_EQ(it->mdSnapshot->get<std::string>("columns"), "a, b, c");
+    EXPECT_EQ(it->mdSnapshot->get<std::string>("runs"), "500-1000");
+    // superseded definitions are not kept in the snapshot
+    EXPECT_EQ(it->mdSnapshot->size(), 3);
+    EXPECT_EQ(it->mdSnapshot->get<std::string>("columns", "", 6), "");
+}
+
+TEST( ExtCSVLoader, readsBlockBySeeking ) {
+    ExtCSVLoader<int> l;
+    std::list<Documents<int>::DataBlock> m;
+    {
+        std::istringstream iss(tstSDCTest1);
+        m = l.get_doc_struct(iss);
+    }
+    ASSERT_EQ(m.size(), 2);
+    const size_t expectedLines[] = {16, 17, 19};
+    size_t i = 0;
+    std::istringstream iss(tstSDCTest1);
+    l.read_block( iss, 600, "TestType1", m.back()
+                , [&]( const aux::MetaInfo & mi
+                     , size_t lineNo
+                     , const std::string & line ) {
+                    EXPECT_LT(i, 3);
+                    if(i >= 3) return false;
+                    EXPECT_EQ(lineNo, expectedLines[i]);
+                    EXPECT_EQ(mi.get<std::string>("columns", "", lineNo), "a, b, c");
+                    EXPECT_EQ(aux::tokenize(line).size(), 3);
+                    ++i;
+                    return true;
+                } );
+    EXPECT_EQ(i, 3);
+    // block is not valid for this key
+    i = 0;
+    std::istringstream iss2(tstSDCTest1);
+    l.read_block( iss2, 110, "TestType1", m.back()
+                , [&]( const aux::MetaInfo &, size_t, const std::string & ) {
+                    ++i;
+                    return true;
+                } );
+    EXPECT_EQ(i, 0);
+}
+
 // Some alternative grammar for "extended CSV"
 //  - no comments
 //  - metadata marker is `#` with single expression form expected
@@ -236,6 +297,76 @@ TEST( ExtCSVLoader, SDCCustomizedParsingValid ) {
     }
 }
 
+TEST( ExtCSVLoader, staticGrammarMatchesRuntime ) {
+    ExtCSVLoader<int> rl;
+    ExtCSVLoader<int, StaticExtCSVGrammar> sl;
+    std::istringstream riss(tstSDCTest1), siss(tstSDCTest1);
+    auto rm = rl.get_doc_struct(riss);
+    auto sm = sl.get_doc_struct(siss);
+    ASSERT_EQ(rm.size(), sm.size());
+    for( auto rit = rm.begin(), sit = sm.begin(); rit != rm.end(); ++rit, ++sit ) {
+        EXPECT_EQ(rit->dataType, sit->dataType);
+        EXPECT_EQ(rit->validityRange.from, sit->validityRange.from);
+        EXPECT_EQ(rit->validityRange.to,   sit->validityRange.to);
+        EXPECT_EQ(rit->blockBgn, sit->blockBgn);
+        EXPECT_EQ(rit->blockOffset, sit->blockOffset);
+    }
+    std::vector<std::pair<size_t, std::string>> rRows, sRows;
+    std::istringstream riss2(tstSDCTest1), siss2(tstSDCTest1);
+    rl.read_data( riss2, 600, "TestType1", 0
+                , [&]( const aux::MetaInfo &, size_t lineNo, const std::string & line ) {
+                    rRows.emplace_back(lineNo, line);
+                    return true;
+                } );
+    sl.read_data( siss2, 600, "TestType1", 0
+                , [&]( const aux::MetaInfo &, size_t lineNo, const std::string & line ) {
+                    sRows.emplace_back(lineNo, line);
+                    return true;
+                } );
+    EXPECT_EQ(rRows.size(), 3);
+    EXPECT_EQ(rRows, sRows);
+}
+
+// Compile-time counterpart of the alternative grammar above
+struct NoTagsGrammar : public StaticExtCSVGrammar {
+    static constexpr char commentChar = '\0'
+                        , metadataMarker = '#';
+    static constexpr std::string_view metadataKeyTag = ""
+                                    , metadataTypeTag = ""
+                                    ;
+};
+
+TEST( ExtCSVLoader, SDCStaticCustomizedParsingValid ) {
+    ExtCSVLoader<size_t, NoTagsGrammar> l;
+    {
+        std::istringstream iss(tstSDCTest2);
+        ASSERT_THROW( l.get_doc_struct(iss)
+                    , sdc::errors::NoDataTypeDefined );
+    }
+    l.defaults.validityRange.from = 1;
+    l.defaults.validityRange.to  = 10;
+    l.defaults.dataType = "TestType2";
+    {
+        std::istringstream iss(tstSDCTest2);
+        auto m = l.get_doc_struct(iss);
+        ASSERT_EQ( m.size(), 1 );
+        EXPECT_EQ( m.front().dataType, "TestType2" );
+    }
+    size_t n = 0;
+    std::istringstream iss(tstSDCTest2);
+    l.read_data( iss, 5, "TestType2", 0
+               , [&]( const aux::MetaInfo & mi
+                    , size_t lineNo
+                    , const std::string & line ) {
+                    EXPECT_EQ( aux::tokenize(line, ',').size(), 3 );
+                    EXPECT_EQ( mi.get<std::string>("", "", lineNo)
+                             , n < 3 ? "123 345" : "234 567" );
+                    ++n;
+                    return true;
+                } );
+    EXPECT_EQ( n, 5 );
+}
+
 }  // namespace ::sdc::test
 }  // namespace sdc
 
@@ -1,6 +1,7 @@
 #include "sdc.hh"
 
 #include <gtest/gtest.h>
+#include <thread>
 
 //
 // Wildcard matching
@@ -56,6 +57,81 @@ TEST(StrUtilTest_tokenize, tokenizesAndTrimsBySpace) {
     }
 }
 
+//
+// Vectorized scanning kernels
+
+TEST(StrUtilTest_simd, kernelsMatchScalarSearch) {
+    using namespace sdc::aux::simd;
+    // buffer of varying content with all the interesting characters at
+    // various positions wrt vector register boundaries
+    std::string buf;
+    const char alphabet[] = "abc #=\t\n\r\v\f1234567890,.xyz\x80\xff";
+    unsigned int seed = 17;
+    for( int i = 0; i < 300; ++i ) {
+        seed = seed*1103515245u + 12345u;
+        buf.push_back(alphabet[(seed >> 16) % (sizeof(alphabet) - 1)]);
+    }
+    for( size_t b = 0; b < 70; ++b ) {
+        for( size_t e = b; e <= buf.size(); e += 7 ) {
+            const char * pb = buf.data() + b
+                     , * pe = buf.data() + e;
+            for( char c : {'#', '=', '\n', 'z', '\xff', '_'} ) {
+                EXPECT_EQ( std::find(pb, pe, c), find_char(pb, pe, c) );
+            }
+            EXPECT_EQ( std::find_if(pb, pe, [](char x){return x == '#' || x == '=';})
+                     , find_any_of(pb, pe, '#', '=') );
+            EXPECT_EQ( std::find_if(pb, pe, [](char x){return std::isspace((unsigned char) x);})
+                     , find_space(pb, pe) );
+            EXPECT_EQ( std::find_if(pb, pe, [](char x){return !std::isspace((unsigned char) x);})
+                     , find_non_space(pb, pe) );
+        }
+    }
+}
+
+TEST(StrUtilTest_tokenize, viewTokensMatchCopies) {
+    using namespace sdc::aux;
+    for( const char * expr : { "", "one", "  one two\tthree  ", "a,b , c,,", " x , y" } ) {
+        const auto toks = tokenize(expr);
+        const Tokens views = tokenize_view(expr);
+        ASSERT_EQ( toks.size(), views.size() ) << expr;
+        EXPECT_TRUE( std::equal(toks.begin(), toks.end(), views.begin()) ) << expr;
+        const auto toksC = tokenize(expr, ',');
+        const Tokens viewsC = tokenize_view(expr, ',');
+        ASSERT_EQ( toksC.size(), viewsC.size() ) << expr;
+        EXPECT_TRUE( std::equal(toksC.begin(), toksC.end(), viewsC.begin()) ) << expr;
+    }
+    // more tokens than kept in place
+    std::string longLine;
+    for( int i = 0; i < 100; ++i ) longLine += std::to_string(i) + " ";
+    const Tokens views = tokenize_view(longLine);
+    ASSERT_EQ( 100u, views.size() );
+    EXPECT_EQ( "0", views[0] );
+    EXPECT_EQ( "99", views.back() );
+    Tokens copy = views;
+    EXPECT_EQ( "57", copy[57] );
+}
+
+TEST(StrUtilTest_tokenize, interpretsViewTokens) {
+    using namespace sdc::aux;
+    MetaInfo md;
+    md.set("columns", "label, value, count", 1);
+    const ColumnsOrder & cols = md.get_ref<ColumnsOrder>("columns");
+    EXPECT_EQ( &cols, &md.get_ref<ColumnsOrder>("columns") );  // cached
+    const std::string line = "foo 1.5e2 42";
+    LoadLog log;
+    auto csv = cols.interpret(tokenize_view(line), &log);
+    EXPECT_EQ( std::string("foo"), (std::string) csv("label") );
+    EXPECT_DOUBLE_EQ( 150., (double) csv("value") );
+    EXPECT_EQ( 42, (int) csv("count") );
+    EXPECT_EQ( 7, csv("missing", 7) );
+    EXPECT_EQ( 42, csv("count", 7) );
+    EXPECT_THROW( csv("missing"), sdc::errors::NoColumnDefinedForTable );
+    EXPECT_THROW( cols.interpret(tokenize_view("foo 1")), sdc::errors::ParserError );
+    // same as for copying tokenizer
+    auto csvC = md.get<ColumnsOrder>("columns").interpret(tokenize(line));
+    EXPECT_EQ( (int) csvC("count"), (int) csv("count") );
+}
+
 //
 // Check for numeric literal
 
@@ -86,6 +162,280 @@ TEST(StrUtilTest_is_numeric, doesNotMatchNonNumerical) {
     EXPECT_FALSE( is_numeric_literal("2+3") );
 }
 
+TEST(StrUtilTest_parse_numeric, convertsLiterals) {
+    using sdc::aux::parse_numeric;
+    int i = 0;
+    EXPECT_EQ( std::errc(), parse_numeric("42", i) );
+    EXPECT_EQ( 42, i );
+    EXPECT_EQ( std::errc(), parse_numeric("+7", i) );
+    EXPECT_EQ( 7, i );
+    EXPECT_EQ( std::errc(), parse_numeric("-13", i) );
+    EXPECT_EQ( -13, i );
+    unsigned long ul = 0;
+    EXPECT_EQ( std::errc(), parse_numeric("18446744073709551615", ul) );
+    EXPECT_EQ( std::numeric_limits<unsigned long>::max(), ul );
+    double d = 0;
+    EXPECT_EQ( std::errc(), parse_numeric("-.033e-64", d) );
+    EXPECT_DOUBLE_EQ( -.033e-64, d );
+    EXPECT_EQ( std::errc(), parse_numeric("+1.5E3", d) );
+    EXPECT_DOUBLE_EQ( 1500., d );
+    EXPECT_EQ( std::errc(), parse_numeric("NaN", d) );
+    EXPECT_TRUE( std::isnan(d) );
+    float f = 0;
+    EXPECT_EQ( std::errc(), parse_numeric("0.25", f) );
+    EXPECT_FLOAT_EQ( .25f, f );
+    // string view needs not to be null-terminated
+    const std::string_view sv("123456", 3);
+    EXPECT_EQ( std::errc(), parse_numeric(sv, i) );
+    EXPECT_EQ( 123, i );
+}
+
+TEST(StrUtilTest_parse_numeric, rejectsMalformedLiterals) {
+    using sdc::aux::parse_numeric;
+    int i = 1;
+    for( const char * s : { "", "+", "a", "12a", " 12", "12 ", "--1", "+-1", "2+3", "1.5" } ) {
+        EXPECT_EQ( std::errc::invalid_argument, parse_numeric(s, i) ) << s;
+    }
+    EXPECT_EQ( 1, i );  // not modified
+    unsigned long ul = 1;
+    EXPECT_EQ( std::errc::invalid_argument, parse_numeric("-1", ul) );
+    double d = 1;
+    for( const char * s : { "", "e", "-e", ".", "1e", "2*3", "1.0.0" } ) {
+        EXPECT_EQ( std::errc::invalid_argument, parse_numeric(s, d) ) << s;
+    }
+    EXPECT_EQ( 1., d );
+    EXPECT_EQ( std::errc::result_out_of_range, parse_numeric("4294967296000", i) );
+    EXPECT_EQ( std::errc::result_out_of_range, parse_numeric("1e400", d) );
+}
+
+TEST(StrUtilTest_parse_numeric, lexicalCastThrowsOnMalformed) {
+    using sdc::aux::lexical_cast;
+    EXPECT_EQ( 12, lexical_cast<int>("12") );
+    EXPECT_EQ( 12ul, lexical_cast<unsigned long>("12") );
+    EXPECT_DOUBLE_EQ( 1.25, lexical_cast<double>("1.25") );
+    EXPECT_THROW( lexical_cast<int>("12a"), sdc::errors::ParserError );
+    EXPECT_THROW( lexical_cast<long>("99999999999999999999"), sdc::errors::ParserError );
+    EXPECT_THROW( sdc::aux::numeric_cast<float>("1e400"), sdc::errors::ParserError );
+    EXPECT_DOUBLE_EQ( 6., lexical_cast<double>("2*3") );
+    EXPECT_THROW( lexical_cast<double>("2*"), sdc::errors::ParserError );
+}
+
+//
+// Arithmetic expressions
+
+TEST(ArithmeticExpression, evaluatesConstantExpressions) {
+    using sdc::aux::evaluate_arithmetic;
+    EXPECT_DOUBLE_EQ( 7., evaluate_arithmetic("1 + 2*3") );
+    EXPECT_DOUBLE_EQ( 9., evaluate_arithmetic("(1 + 2)*3") );
+    EXPECT_DOUBLE_EQ( 1., evaluate_arithmetic("8/4/2") );
+    EXPECT_DOUBLE_EQ( 2., evaluate_arithmetic("10 - 5 - 3") );
+    EXPECT_DOUBLE_EQ( -4., evaluate_arithmetic("-2^2") );
+    EXPECT_DOUBLE_EQ( 512., evaluate_arithmetic("2^3^2") );
+    EXPECT_DOUBLE_EQ( 0.25, evaluate_arithmetic("2**-2") );
+    EXPECT_DOUBLE_EQ( 1.5e-3, evaluate_arithmetic("1.5e-3") );
+    EXPECT_DOUBLE_EQ( 3., evaluate_arithmetic(" sqrt( 9 ) ") );
+    EXPECT_DOUBLE_EQ( 8., evaluate_arithmetic("pow(2, 1+2)") );
+    EXPECT_DOUBLE_EQ( 1., evaluate_arithmetic("log(e)") );
+    EXPECT_DOUBLE_EQ( 2., evaluate_arithmetic("log10(100)") );
+    EXPECT_DOUBLE_EQ( 1., evaluate_arithmetic("exp(0)") );
+    EXPECT_DOUBLE_EQ( 0.5, evaluate_arithmetic("abs(-1/2)") );
+    EXPECT_NEAR( 0., evaluate_arithmetic("sin(pi)"), 1e-12 );
+    EXPECT_DOUBLE_EQ( -1., evaluate_arithmetic("cos(pi)") );
+}
+
+TEST(ArithmeticExpression, rejectsMalformedExpressions) {
+    using sdc::aux::evaluate_arithmetic;
+    for( const char * s : { "", "()", "1 +", "(1", "1)", "2 3", "foo(1)"
+                          , "bar", "pow(2)", "1 $ 2", "1e" } ) {
+        EXPECT_THROW( evaluate_arithmetic(s), sdc::errors::ParserError ) << s;
+    }
+}
+
+TEST(ArithmeticExpression, castsAreMemoized) {
+    using sdc::aux::eval_arithmetic_expression;
+    const std::string expr = "sqrt(2)*(1 + 1/3)";
+    const double v = eval_arithmetic_expression(expr);
+    EXPECT_DOUBLE_EQ( std::sqrt(2.)*(1 + 1./3), v );
+    EXPECT_EQ( v, eval_arithmetic_expression(expr) );
+    EXPECT_FLOAT_EQ( (float) v, sdc::aux::lexical_cast<float>(expr) );
+    EXPECT_THROW( eval_arithmetic_expression("sqrt(2"), sdc::errors::ParserError );
+}
+
+//
+// String interning
+
+TEST(AtomTest, internsEqualStrings) {
+    using sdc::aux::Atom;
+    const std::string one("TestData/One");
+    const Atom a(one), b("TestData/One"), c(std::string_view("TestData/Onex", 12));
+    EXPECT_EQ( &a.str(), &b.str() );
+    EXPECT_EQ( &a.str(), &c.str() );
+    EXPECT_TRUE( a == b );
+    EXPECT_EQ( a, one );
+    EXPECT_EQ( "TestData/One", a );
+    EXPECT_NE( a, "TestData/Two" );
+    EXPECT_NE( a, Atom("TestData/Two") );
+    EXPECT_LT( a, Atom("TestData/Two") );
+    EXPECT_FALSE( a < b );
+    EXPECT_EQ( Atom::Hash{}(a), Atom::Hash{}(b) );
+    EXPECT_TRUE( Atom().empty() );
+    EXPECT_EQ( Atom(), Atom("") );
+    std::ostringstream oss;
+    oss << a;
+    EXPECT_EQ( one, oss.str() );
+}
+
+TEST(AtomTest, internsSameStringAcrossThreads) {
+    using sdc::aux::Atom;
+    const std::string * fromThreads[4];
+    std::vector<std::thread> ts;
+    for( int i = 0; i < 4; ++i ) {
+        ts.emplace_back([i, &fromThreads](){
+                fromThreads[i] = &Atom("shared/atom/value").str();
+            });
+    }
+    for( auto & t : ts ) t.join();
+    const Atom a("shared/atom/value");
+    for( int i = 0; i < 4; ++i ) EXPECT_EQ( &a.str(), fromThreads[i] );
+}
+
+TEST(AtomTest, queriesDoNotIntern) {
+    using sdc::aux::Atom;
+    EXPECT_FALSE( Atom::find("never/interned/key") );
+    // metadata queries
+    sdc::aux::MetaInfo md;
+    md.set("defined/key", "1", 1);
+    EXPECT_FALSE( md.has("never/interned/key") );
+    EXPECT_EQ( md.find_strexpr("never/interned/key"), nullptr );
+    EXPECT_EQ( md.get<int>("never/interned/key", 5), 5 );
+    EXPECT_THROW( md.get<int>("never/interned/key")
+                , sdc::errors::NoMetadataEntryInFile );
+    md.drop("never/interned/key");
+    // index queries
+    sdc::ValidityIndex<int, sdc::aux::MetaInfo> index;
+    EXPECT_TRUE( index.updates("never/interned/type", 1, true).empty() );
+    EXPECT_THROW( index.updates("never/interned/type", 1)
+                , sdc::errors::UnknownDataType );
+    EXPECT_FALSE( index.expires("never/interned/type", 1, 2) );
+    EXPECT_EQ( index.remove_document("never/interned/doc"), 0 );
+    EXPECT_FALSE( Atom::find("never/interned/key") );
+    EXPECT_FALSE( Atom::find("never/interned/type") );
+    EXPECT_FALSE( Atom::find("never/interned/doc") );
+    // stored strings are interned
+    ASSERT_TRUE( Atom::find("defined/key") );
+    EXPECT_EQ( *Atom::find("defined/key"), Atom("defined/key") );
+    EXPECT_EQ( md.find_strexpr(Atom("defined/key")), md.find_strexpr("defined/key") );
+    EXPECT_EQ( md.get<int>("defined/key"), 1 );
+}
+
+//
+// Metadata
+
+TEST(MetaInfoTest, providesRowLineWithoutStoringIt) {
+    using namespace sdc::aux;
+    MetaInfo md;
+    md.set("columns", "a, b", 1);
+    EXPECT_FALSE( md.has("@lineNo") );
+    md.set_row_line(12);
+    EXPECT_TRUE( md.has("@lineNo") );
+    EXPECT_EQ( md.get<size_t>("@lineNo"), 12u );
+    EXPECT_EQ( md.get_strexpr("@lineNo"), "12" );
+    EXPECT_EQ( md.get<int>("@lineNo", 0, 5), 12 );  // defined for any line
+    const size_t & ref = md.get_ref<size_t>("@lineNo");
+    md.set_row_line(13);
+    EXPECT_EQ( md.get<size_t>("@lineNo"), 13u );
+    EXPECT_EQ( ref, 13u );  // cached value follows the row
+    EXPECT_EQ( md.size(), 1u );  // entries are not modified
+    // copies do not inherit the row
+    MetaInfo copy(md);
+    EXPECT_FALSE( copy.has("@lineNo") );
+    md.set_row_line(MetaInfo::noRow);
+    EXPECT_FALSE( md.has("@lineNo") );
+    // shared snapshots are not modified by row readers
+    RowMetaInfo rows;
+    EXPECT_EQ( rows.at(copy, 7).get<size_t>("@lineNo"), 7u );
+    EXPECT_EQ( rows.at(copy, 8).get<std::string>("columns"), "a, b" );
+    EXPECT_EQ( rows.get().row_line(), 8u );
+    EXPECT_FALSE( copy.has("@lineNo") );
+}
+
+//
+// Arena allocator
+
+TEST(ArenaTest, allocatesAlignedAndReusesChunks) {
+    sdc::aux::Arena arena(256);
+    for( size_t align : {1, 2, 8, 16, 64} ) {
+        void * p = arena.allocate(3, align);
+        EXPECT_EQ( 0u, reinterpret_cast<uintptr_t>(p) % align );
+    }
+    // block larger than the chunk gets a dedicated one
+    char * big = static_cast<char *>(arena.allocate(1000, 1));
+    memset(big, 'x', 1000);
+    const std::string_view sv = arena.copy("some token");
+    EXPECT_EQ( "some token", sv );
+    EXPECT_GT( arena.n_bytes(), 1000u );
+    const size_t capacity = arena.capacity();
+    arena.reset();
+    EXPECT_EQ( 0u, arena.n_bytes() );
+    EXPECT_EQ( capacity, arena.capacity() );
+    arena.allocate(1000, 1);
+    EXPECT_EQ( capacity, arena.capacity() );  // no new chunks
+    arena.reset(0);
+    EXPECT_EQ( 0u, arena.capacity() );
+}
+
+TEST(ArenaTest, scopeProvidesArenaForContainers) {
+    using namespace sdc::aux;
+    EXPECT_EQ( nullptr, Arena::current() );
+    {
+        ArenaVector<int> heapVec;  // no arena -- uses heap
+        EXPECT_EQ( nullptr, heapVec.get_allocator().arena );
+        heapVec.assign(100, 1);
+    }
+    {
+        ArenaScope scope;
+        Arena * arena = Arena::current();
+        ASSERT_NE( nullptr, arena );
+        {
+            ArenaScope nested;
+            EXPECT_EQ( arena, Arena::current() );
+        }
+        EXPECT_EQ( arena, Arena::current() );
+        ArenaVector<int> v;
+        EXPECT_EQ( arena, v.get_allocator().arena );
+        for( int i = 0; i < 1000; ++i ) v.push_back(i);
+        EXPECT_EQ( 999, v.back() );
+        ArenaString str("a string long enough to exceed short string buffer");
+        EXPECT_EQ( 'a', str[0] );
+        EXPECT_GE( arena->n_bytes(), 1000*sizeof(int) );
+    }
+    EXPECT_EQ( nullptr, Arena::current() );
+}
+
+TEST(ArenaTest, interpretedLineDoesNotUseArena) {
+    using namespace sdc::aux;
+    MetaInfo md;
+    md.set("columns", "label, value, count", 1);
+    const ColumnsOrder & cols = md.get_ref<ColumnsOrder>("columns");
+    ColumnsOrder::CSVLine kept;
+    {
+        ArenaScope scope;
+        auto csv = cols.interpret(tokenize(" foo,  1.5 ,42 ", ','));
+        // public type, may be kept by user code after the scope
+        const std::unordered_map<std::string, std::string> & m = csv;
+        EXPECT_EQ( 3u, m.size() );
+        kept = csv;
+    }
+    {
+        ArenaScope scope;  // re-uses arena memory
+        ArenaString str(1024, 'x');
+        EXPECT_EQ( 'x', str[0] );
+    }
+    EXPECT_EQ( std::string("foo"), (std::string) kept("label") );
+    EXPECT_DOUBLE_EQ( 1.5, (double) kept("value") );
+    EXPECT_EQ( 42, kept("count", 0) );
+}
+
 //
 // Line reading
 
@@ -167,6 +517,46 @@ blah 123	blah 456	# comment will go; preserve the tabs, 10
     EXPECT_FALSE( sdc::aux::getline( iss, line, lineNo, comment_f ) );
 }
 
+TEST(LineReaderTest, yieldsStrippedViewsWithOffsets) {
+    const std::string doc = "# This is a comment line, be ignored, 1\n"
+                            "foo=bar  # this must not, 2\n"
+                            "\n"
+                            "  one  \t\n"
+                            "blah 123\tblah 456\t# comment will go, 5";
+    const struct {
+        size_t lineNo;
+        const char content[128];
+    } expected[] = {
+        {  2, "foo=bar"},
+        {  4, "one"},
+        {  5, "blah 123\tblah 456"},
+    };
+    auto comment_f = [](std::string_view l) {
+                    return std::pair<size_t, size_t>(l.find('#'), std::string::npos);
+                };
+    sdc::aux::LineReader reader(doc);
+    std::string_view line;
+    std::string scratch;
+    size_t offset, i = 0;
+    while( reader.next(line, offset) ) {
+        EXPECT_EQ( doc.substr(offset, line.size()), line );
+        sdc::aux::strip_line_view(line, scratch, comment_f);
+        if( line.empty() ) continue;
+        ASSERT_LT( i, sizeof(expected)/sizeof(*expected) );
+        EXPECT_EQ( expected[i].lineNo, reader.line_number() );
+        EXPECT_EQ( expected[i].content, line );
+        // view must refer to the document, not a copy
+        EXPECT_TRUE( line.data() >= doc.data() && line.data() < doc.data() + doc.size() );
+        ++i;
+    }
+    EXPECT_EQ( i, sizeof(expected)/sizeof(*expected) );
+    // re-positioning
+    reader.seek(doc.find("  one"), 3);
+    ASSERT_TRUE( reader.next(line, offset) );
+    EXPECT_EQ( reader.line_number(), 4 );
+    EXPECT_EQ( sdc::aux::trim_view(line), "one" );
+}
+
 #if 0
 TEST(CustomGetlineTest, treatsComplexComments) {
     // A testing expression
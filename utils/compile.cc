@@ -0,0 +1,67 @@
+#include <iostream>
+#include <unistd.h>
+#include "sdc.hh"
+
+// Compiles ExtCSV documents found in directory (or single document) into
+// binary container readable by `sdc::BinaryLoader`.
+
+static void
+usage(const char * appName, std::ostream & os) {
+    os << "Usage:" << std::endl
+       << "    " << appName << " [-t <type>] [-a <accept>] [-r <reject>]"
+          " -o <output> <path>" << std::endl
+       << "Compiles ExtCSV documents found at <path> (file or directory) into"
+          " binary container <output>." << std::endl
+       << "Options:" << std::endl
+       << "    -t <type>    default data type of the blocks" << std::endl
+       << "    -a <accept>  colon-separated wildcards of documents to accept"
+          " (default is \"*.txt:*.dat:*.txt.gz:*.dat.gz:*.txt.xz:*.dat.xz:*.txt.zst:*.dat.zst\")"
+       << std::endl
+       << "    -r <reject>  colon-separated wildcards of documents to reject"
+       << std::endl;
+}
+
+int
+main(int argc, char * argv[]) {
+    typedef int RunType;
+
+    std::string outPath
+              , defaultType
+              , acceptPatterns = "*.txt:*.dat:*.txt.gz:*.dat.gz:*.txt.xz:*.dat.xz:*.txt.zst:*.dat.zst"
+              , rejectPatterns = "*.swp:*.swo:*.bak:*.BAK:*.bck:~*:*-orig.txt:*.dev"
+              ;
+    int c;
+    while( (c = getopt(argc, argv, "ht:a:r:o:")) != -1 ) {
+        switch(c) {
+            case 't': defaultType = optarg; break;
+            case 'a': acceptPatterns = optarg; break;
+            case 'r': rejectPatterns = optarg; break;
+            case 'o': outPath = optarg; break;
+            case 'h': usage(argv[0], std::cout); return 0;
+            default: usage(argv[0], std::cerr); return 1;
+        }
+    }
+    if( outPath.empty() || optind + 1 != argc ) {
+        usage(argv[0], std::cerr);
+        return 1;
+    }
+
+    sdc::ExtCSVLoader<RunType> loader;
+    loader.defaults.dataType = defaultType;
+    std::vector<std::string> docIDs;
+    sdc::aux::FS fs( argv[optind], acceptPatterns, rejectPatterns
+                   , 10, 1024*1024*1024  // same size limits as load_from_fs()
+                   );
+    std::string docID;
+    while( !(docID = fs()).empty() ) docIDs.push_back(docID);
+    try {
+        size_t nBlocks = sdc::compile_binary<RunType>(loader, docIDs, outPath);
+        std::cout << "Compiled " << nBlocks << " block(s) of "
+                  << docIDs.size() << " document(s) into \"" << outPath
+                  << "\"." << std::endl;
+    } catch( std::exception & e ) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}